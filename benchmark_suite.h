@@ -0,0 +1,528 @@
+/**
+ * benchmark_suite.h
+ * Non-interactive benchmark regression suite: runs a fixed matrix of
+ * algorithms x sizes x data distributions, writes the results as JSON and
+ * compares them against a stored baseline
+ */
+
+ #ifndef BENCHMARK_SUITE_H
+ #define BENCHMARK_SUITE_H
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include "memory_policy.h"
+ #include "sorting_algorithms.h"
+
+ #define BENCH_MAX_REPEATS 101
+ #define BENCH_DEFAULT_REPEATS 11
+ #define BENCH_WARMUP_RUNS 1              // Untimed runs before the measured repeats
+ #define BENCH_QUADRATIC_MAX_SIZE 10000   // O(n²) cases only run at the smallest size
+ #define BENCH_WORD_MAX_LENGTH 20
+ #define BENCH_MAX_CASES 512
+
+ // Regression rule defaults: a case is suspect when its median exceeds the baseline median by
+ // more than the relative tolerance, BENCH_NOISE_MADS times the larger MAD and the absolute floor,
+ // and its fastest run is also slower than the baseline's by more than the tolerance and the floor.
+ // A suspect case is timed again up to BENCH_CONFIRM_ROUNDS times and only fails the gate when
+ // every re-run is still suspect, so a burst of interference during one pass cannot fail it.
+ // The floor keeps cases of a few milliseconds, where timer and scheduler jitter dominate, ungated.
+ #define BENCH_DEFAULT_TOLERANCE 0.15
+ #define BENCH_NOISE_MADS 3.0
+ #define BENCH_ABSOLUTE_FLOOR 0.005
+ #define BENCH_CONFIRM_ROUNDS 3
+
+ typedef void (*bench_sort_func)(void*, size_t, size_t, int(*)(const void*, const void*));
+
+ typedef struct {
+     const char *name;
+     bench_sort_func func;
+     int quadratic;          // O(n²) on every input
+     int quadratic_presorted; // O(n²) on sorted or duplicate-heavy input (last-element pivot)
+ } bench_algorithm;
+
+ typedef enum {
+     BENCH_INT_RANDOM = 0,
+     BENCH_INT_SORTED,
+     BENCH_INT_REVERSED,
+     BENCH_INT_NEARLY_SORTED,
+     BENCH_INT_FEW_UNIQUE,
+     BENCH_WORD_RANDOM,
+     BENCH_DISTRIBUTION_COUNT
+ } bench_distribution;
+
+ typedef struct {
+     char algorithm[64];
+     char data[64];
+     size_t size;
+     int runs;
+     double median;
+     double mad;
+     double min;
+ } bench_result;
+
+ static const bench_algorithm bench_algorithms[] = {
+     { "bubble_sort", bubble_sort, 1, 1 },
+     { "selection_sort", selection_sort, 1, 1 },
+     { "insertion_sort", insertion_sort, 1, 1 },
+     { "merge_sort", merge_sort, 0, 0 },
+     { "quick_sort", quick_sort, 0, 1 },
+     { "shell_sort", shell_sort, 0, 0 },
+     { "merge_sort_bottom_up", merge_sort_bottom_up, 0, 0 },
+ };
+
+ static const char *bench_distribution_names[BENCH_DISTRIBUTION_COUNT] = {
+     "int_random", "int_sorted", "int_reversed", "int_nearly_sorted", "int_few_unique", "word_random"
+ };
+
+ static const size_t bench_sizes[] = { 10000, 100000, 1000000 };
+
+ /**
+  * Deterministic xorshift64 generator so every run sorts exactly the same data
+  */
+ unsigned long long bench_next_random(unsigned long long *state) {
+     unsigned long long x = *state;
+     x ^= x << 13;
+     x ^= x >> 7;
+     x ^= x << 17;
+     *state = x;
+     return x;
+ }
+
+ int bench_compare_int(const void *a, const void *b) {
+     int x = *(const int *)a;
+     int y = *(const int *)b;
+     return (x > y) - (x < y);
+ }
+
+ int bench_compare_string(const void *a, const void *b) {
+     return strcmp(*(char * const *)a, *(char * const *)b);
+ }
+
+ /**
+  * Fills data with n integers of the given distribution
+  */
+ void bench_fill_ints(int *data, size_t n, bench_distribution dist) {
+     unsigned long long state = 0x9E3779B97F4A7C15ULL + (unsigned long long)dist;
+
+     for (size_t i = 0; i < n; i++) {
+         switch (dist) {
+             case BENCH_INT_SORTED:
+             case BENCH_INT_NEARLY_SORTED:
+                 data[i] = (int)i;
+                 break;
+             case BENCH_INT_REVERSED:
+                 data[i] = (int)(n - i);
+                 break;
+             case BENCH_INT_FEW_UNIQUE:
+                 data[i] = (int)(bench_next_random(&state) % 100);
+                 break;
+             default:
+                 data[i] = (int)(bench_next_random(&state) % 2000000);
+                 break;
+         }
+     }
+
+     // Nearly sorted: swap 1% of the elements with random partners
+     if (dist == BENCH_INT_NEARLY_SORTED && n > 1) {
+         for (size_t k = 0; k < n / 100; k++) {
+             size_t i = bench_next_random(&state) % n;
+             size_t j = bench_next_random(&state) % n;
+             int temp = data[i];
+             data[i] = data[j];
+             data[j] = temp;
+         }
+     }
+ }
+
+ /**
+  * Fills words with n random lowercase words of 3 to 19 letters, like generate_words.c.
+  * Each word points into storage, which needs n * BENCH_WORD_MAX_LENGTH bytes.
+  */
+ void bench_fill_words(char **words, char *storage, size_t n) {
+     unsigned long long state = 0xD1B54A32D192ED03ULL;
+
+     for (size_t i = 0; i < n; i++) {
+         char *word = storage + i * BENCH_WORD_MAX_LENGTH;
+         int length = (int)(bench_next_random(&state) % (BENCH_WORD_MAX_LENGTH - 3)) + 3;
+
+         for (int c = 0; c < length; c++) {
+             word[c] = (char)('a' + bench_next_random(&state) % 26);
+         }
+         word[length] = '\0';
+         words[i] = word;
+     }
+ }
+
+ int bench_compare_double(const void *a, const void *b) {
+     double x = *(const double *)a;
+     double y = *(const double *)b;
+     return (x > y) - (x < y);
+ }
+
+ /**
+  * Median of n samples (sorts the samples in place)
+  */
+ double bench_median(double *samples, int n) {
+     qsort(samples, n, sizeof(double), bench_compare_double);
+     return (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+ }
+
+ /**
+  * Whether a matrix cell runs: quadratic cases are limited to the smallest size
+  */
+ int bench_case_enabled(const bench_algorithm *algo, bench_distribution dist, size_t size) {
+     if (size <= BENCH_QUADRATIC_MAX_SIZE) return 1;
+     if (algo->quadratic) return 0;
+     if (algo->quadratic_presorted && dist != BENCH_INT_RANDOM && dist != BENCH_WORD_RANDOM) return 0;
+     return 1;
+ }
+
+ /**
+  * Times one matrix cell `repeats` times on fresh copies of source, after
+  * BENCH_WARMUP_RUNS untimed runs that fault in the scratch pages and warm the caches.
+  * Returns 0 on success, -1 on allocation failure or an unsorted result.
+  */
+ int bench_run_case(const bench_algorithm *algo, bench_distribution dist, const void *source, size_t size,
+                    int repeats, bench_result *result) {
+     size_t elem_size = (dist == BENCH_WORD_RANDOM) ? sizeof(char*) : sizeof(int);
+     int (*compare)(const void*, const void*) = (dist == BENCH_WORD_RANDOM) ? bench_compare_string : bench_compare_int;
+     double samples[BENCH_MAX_REPEATS];
+
+     unsigned char *work = (unsigned char *)mem_alloc(size * elem_size, MEM_ROLE_SCRATCH);
+     if (!work) return -1;
+
+     for (int r = -BENCH_WARMUP_RUNS; r < repeats; r++) {
+         memcpy(work, source, size * elem_size);
+
+         clock_t start = clock();
+         algo->func(work, size, elem_size, compare);
+         clock_t end = clock();
+         if (r >= 0) samples[r] = ((double) (end - start)) / CLOCKS_PER_SEC;
+
+         for (size_t i = 1; i < size; i++) {
+             if (compare(work + (i - 1) * elem_size, work + i * elem_size) > 0) {
+                 fprintf(stderr, "Error: %s did not sort %s (%zu)\n", algo->name, bench_distribution_names[dist], size);
+                 mem_free(work);
+                 return -1;
+             }
+         }
+     }
+     mem_free(work);
+
+     snprintf(result->algorithm, sizeof(result->algorithm), "%s", algo->name);
+     snprintf(result->data, sizeof(result->data), "%s", bench_distribution_names[dist]);
+     result->size = size;
+     result->runs = repeats;
+
+     double deviations[BENCH_MAX_REPEATS];
+     result->median = bench_median(samples, repeats);
+     result->min = samples[0];
+     for (int r = 0; r < repeats; r++) {
+         double d = samples[r] - result->median;
+         deviations[r] = d < 0 ? -d : d;
+     }
+     result->mad = bench_median(deviations, repeats);
+     return 0;
+ }
+
+ /**
+  * Writes the results as JSON, one case per line so baselines diff cleanly
+  */
+ int bench_write_json(const char *path, const char *variant, const bench_result *results, size_t count) {
+     FILE *file = fopen(path, "w");
+     if (!file) {
+         perror("Failed to open benchmark output file");
+         return -1;
+     }
+
+     fprintf(file, "{\n  \"variant\": \"%s\",\n  \"cases\": [\n", variant);
+     for (size_t i = 0; i < count; i++) {
+         fprintf(file, "    {\"algorithm\": \"%s\", \"data\": \"%s\", \"size\": %zu, \"runs\": %d, "
+                       "\"median_s\": %.6f, \"mad_s\": %.6f, \"min_s\": %.6f}%s\n",
+                 results[i].algorithm, results[i].data, results[i].size, results[i].runs,
+                 results[i].median, results[i].mad, results[i].min, (i + 1 < count) ? "," : "");
+     }
+     fprintf(file, "  ]\n}\n");
+
+     fclose(file);
+     return 0;
+ }
+
+ /**
+  * Reads a file written by bench_write_json. Returns the number of cases or -1.
+  */
+ long bench_read_json(const char *path, bench_result *results, size_t capacity) {
+     FILE *file = fopen(path, "r");
+     if (!file) return -1;
+
+     char line[512];
+     size_t count = 0;
+     while (count < capacity && fgets(line, sizeof(line), file)) {
+         bench_result *r = &results[count];
+         if (sscanf(line, " {\"algorithm\": \"%63[^\"]\", \"data\": \"%63[^\"]\", \"size\": %zu, \"runs\": %d, "
+                          "\"median_s\": %lf, \"mad_s\": %lf, \"min_s\": %lf",
+                    r->algorithm, r->data, &r->size, &r->runs, &r->median, &r->mad, &r->min) == 7) {
+             count++;
+         }
+     }
+
+     fclose(file);
+     return (long)count;
+ }
+
+ /**
+  * Times the case described by previous again on freshly generated data.
+  * Returns 0 on success, -1 if the case is unknown or fails.
+  */
+ int bench_retime_case(const bench_result *previous, int repeats, bench_result *result) {
+     size_t algo_count = sizeof(bench_algorithms) / sizeof(bench_algorithms[0]);
+     const bench_algorithm *algo = NULL;
+     int dist = 0;
+
+     for (size_t a = 0; a < algo_count; a++) {
+         if (strcmp(bench_algorithms[a].name, previous->algorithm) == 0) algo = &bench_algorithms[a];
+     }
+     while (dist < BENCH_DISTRIBUTION_COUNT && strcmp(bench_distribution_names[dist], previous->data) != 0) {
+         dist++;
+     }
+     if (!algo || dist == BENCH_DISTRIBUTION_COUNT) return -1;
+
+     size_t size = previous->size;
+     int status = -1;
+     if (dist == BENCH_WORD_RANDOM) {
+         char **words = (char **)mem_alloc(size * sizeof(char*), MEM_ROLE_SHARED);
+         char *storage = (char *)mem_alloc(size * BENCH_WORD_MAX_LENGTH, MEM_ROLE_SHARED);
+         if (words && storage) {
+             bench_fill_words(words, storage, size);
+             status = bench_run_case(algo, (bench_distribution)dist, words, size, repeats, result);
+         }
+         mem_free(words);
+         mem_free(storage);
+     } else {
+         int *ints = (int *)mem_alloc(size * sizeof(int), MEM_ROLE_SHARED);
+         if (ints) {
+             bench_fill_ints(ints, size, (bench_distribution)dist);
+             status = bench_run_case(algo, (bench_distribution)dist, ints, size, repeats, result);
+         }
+         mem_free(ints);
+     }
+
+     return status;
+ }
+
+ /**
+  * Slowdown of the median that still counts as noise for this pair of results
+  */
+ double bench_allowed_slowdown(const bench_result *cur, const bench_result *base, double tolerance) {
+     double noise = (base->mad > cur->mad ? base->mad : cur->mad) * BENCH_NOISE_MADS;
+     double allowed = base->median * tolerance;
+     if (noise > allowed) allowed = noise;
+     if (BENCH_ABSOLUTE_FLOOR > allowed) allowed = BENCH_ABSOLUTE_FLOOR;
+     return allowed;
+ }
+
+ /**
+  * Whether cur is slower than base by more than noise, both in median and in fastest run
+  */
+ int bench_is_regression(const bench_result *cur, const bench_result *base, double tolerance) {
+     double allowed_min = base->min * tolerance;
+     if (BENCH_ABSOLUTE_FLOOR > allowed_min) allowed_min = BENCH_ABSOLUTE_FLOOR;
+
+     return cur->median - base->median > bench_allowed_slowdown(cur, base, tolerance) &&
+            cur->min - base->min > allowed_min;
+ }
+
+ /**
+  * Compares current results with the baseline and prints one row per case.
+  * Suspect cases are re-timed; a case that passes a re-run keeps that result.
+  * Returns the number of regressed cases, or -1 if a re-run failed.
+  */
+ int bench_compare_baseline(bench_result *current, size_t count, const bench_result *baseline,
+                            size_t baseline_count, double tolerance, int repeats) {
+     int regressions = 0;
+
+     printf("| %-22s | %-18s | %-8s | %-10s | %-10s | %-8s | %-10s |\n",
+            "Algoritma", "Data", "Jumlah", "Baseline", "Sekarang", "Delta", "Status");
+     for (int i = 0; i < 106; i++) printf("-");
+     printf("\n");
+
+     for (size_t i = 0; i < count; i++) {
+         bench_result *cur = &current[i];
+         const bench_result *base = NULL;
+
+         for (size_t j = 0; j < baseline_count; j++) {
+             if (baseline[j].size == cur->size && strcmp(baseline[j].algorithm, cur->algorithm) == 0 &&
+                 strcmp(baseline[j].data, cur->data) == 0) {
+                 base = &baseline[j];
+                 break;
+             }
+         }
+
+         if (!base) {
+             printf("| %-22s | %-18s | %-8zu | %-10s | %-10.4f | %-8s | %-10s |\n",
+                    cur->algorithm, cur->data, cur->size, "-", cur->median, "-", "baru");
+             continue;
+         }
+
+         const char *status = "OK";
+         if (bench_is_regression(cur, base, tolerance)) {
+             status = "REGRESI";
+
+             // One slow pass is not enough: time the case again and fail only if it stays slow
+             for (int round = 0; round < BENCH_CONFIRM_ROUNDS; round++) {
+                 bench_result retry;
+                 if (bench_retime_case(cur, repeats, &retry) != 0) return -1;
+
+                 if (!bench_is_regression(&retry, base, tolerance)) {
+                     *cur = retry;
+                     status = "OK (ulang)";
+                     break;
+                 }
+                 if (retry.median < cur->median) *cur = retry;
+             }
+             if (strcmp(status, "REGRESI") == 0) regressions++;
+         } else if (base->median - cur->median > bench_allowed_slowdown(cur, base, tolerance)) {
+             status = "lebih cepat";
+         }
+
+         double delta = cur->median - base->median;
+         double delta_pct = base->median > 0.0 ? 100.0 * delta / base->median : 0.0;
+
+         printf("| %-22s | %-18s | %-8zu | %-10.4f | %-10.4f | %+7.1f%% | %-10s |\n",
+                cur->algorithm, cur->data, cur->size, base->median, cur->median, delta_pct, status);
+     }
+
+     return regressions;
+ }
+
+ void bench_print_usage(const char *program) {
+     printf("Penggunaan: %s --bench [opsi]\n", program);
+     printf("  --variant NAMA      Label build yang disimpan di JSON (default: default)\n");
+     printf("  --output FILE       Tulis hasil ke FILE dalam format JSON\n");
+     printf("  --baseline FILE     Bandingkan dengan baseline; exit 1 bila ada regresi\n");
+     printf("  --repeat N          Jumlah pengulangan per kasus (default: %d)\n", BENCH_DEFAULT_REPEATS);
+     printf("  --max-size N        Lewati ukuran data di atas N\n");
+     printf("  --tolerance X       Toleransi relatif regresi (default: %.2f)\n", BENCH_DEFAULT_TOLERANCE);
+ }
+
+ /**
+  * Entry point for `sorting_test --bench ...`. Returns the process exit status:
+  * 0 when everything ran and nothing regressed, 1 on regression, 2 on errors.
+  */
+ int run_benchmark_suite(int argc, char *argv[]) {
+     const char *variant = "default";
+     const char *output_path = NULL;
+     const char *baseline_path = NULL;
+     int repeats = BENCH_DEFAULT_REPEATS;
+     size_t max_size = (size_t)-1;
+     double tolerance = BENCH_DEFAULT_TOLERANCE;
+
+     for (int i = 2; i < argc; i++) {
+         const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+         if (strcmp(argv[i], "--variant") == 0 && value) {
+             variant = value;
+         } else if (strcmp(argv[i], "--output") == 0 && value) {
+             output_path = value;
+         } else if (strcmp(argv[i], "--baseline") == 0 && value) {
+             baseline_path = value;
+         } else if (strcmp(argv[i], "--repeat") == 0 && value) {
+             repeats = atoi(value);
+         } else if (strcmp(argv[i], "--max-size") == 0 && value) {
+             max_size = (size_t)strtoull(value, NULL, 10);
+         } else if (strcmp(argv[i], "--tolerance") == 0 && value) {
+             tolerance = atof(value);
+         } else {
+             bench_print_usage(argv[0]);
+             return 2;
+         }
+         i++;
+     }
+
+     if (repeats < 1 || repeats > BENCH_MAX_REPEATS) {
+         printf("Jumlah pengulangan harus 1-%d\n", BENCH_MAX_REPEATS);
+         return 2;
+     }
+
+     static bench_result results[BENCH_MAX_CASES];
+     size_t result_count = 0;
+     size_t algo_count = sizeof(bench_algorithms) / sizeof(bench_algorithms[0]);
+     size_t size_count = sizeof(bench_sizes) / sizeof(bench_sizes[0]);
+
+     printf("=== Benchmark Regression Suite (variant: %s, %d pengulangan) ===\n", variant, repeats);
+
+     for (size_t s = 0; s < size_count; s++) {
+         size_t size = bench_sizes[s];
+         if (size > max_size) continue;
+
+         int *ints = (int *)mem_alloc(size * sizeof(int), MEM_ROLE_SHARED);
+         char **words = (char **)mem_alloc(size * sizeof(char*), MEM_ROLE_SHARED);
+         char *storage = (char *)mem_alloc(size * BENCH_WORD_MAX_LENGTH, MEM_ROLE_SHARED);
+         if (!ints || !words || !storage) {
+             perror("Memory allocation failed");
+             mem_free(ints);
+             mem_free(words);
+             mem_free(storage);
+             return 2;
+         }
+         bench_fill_words(words, storage, size);
+
+         for (int d = 0; d < BENCH_DISTRIBUTION_COUNT; d++) {
+             bench_distribution dist = (bench_distribution)d;
+             if (dist != BENCH_WORD_RANDOM) {
+                 bench_fill_ints(ints, size, dist);
+             }
+             const void *source = (dist == BENCH_WORD_RANDOM) ? (const void *)words : (const void *)ints;
+
+             for (size_t a = 0; a < algo_count; a++) {
+                 if (!bench_case_enabled(&bench_algorithms[a], dist, size)) continue;
+
+                 bench_result *result = &results[result_count];
+                 if (bench_run_case(&bench_algorithms[a], dist, source, size, repeats, result) != 0) {
+                     mem_free(ints);
+                     mem_free(words);
+                     mem_free(storage);
+                     return 2;
+                 }
+
+                 printf("%-22s %-18s %-8zu median %.4f s (MAD %.4f)\n",
+                        result->algorithm, result->data, result->size, result->median, result->mad);
+                 fflush(stdout);
+                 result_count++;
+             }
+         }
+
+         mem_free(ints);
+         mem_free(words);
+         mem_free(storage);
+     }
+
+     int regressions = 0;
+     if (baseline_path) {
+         static bench_result baseline[BENCH_MAX_CASES];
+         long baseline_count = bench_read_json(baseline_path, baseline, BENCH_MAX_CASES);
+         if (baseline_count < 0) {
+             printf("Baseline %s tidak ditemukan. Buat dengan 'make bench-baseline'.\n", baseline_path);
+             return 2;
+         }
+
+         printf("\n=== Perbandingan dengan baseline %s ===\n", baseline_path);
+         regressions = bench_compare_baseline(results, result_count, baseline, (size_t)baseline_count,
+                                              tolerance, repeats);
+         if (regressions < 0) return 2;
+         printf("\n%d kasus regresi (toleransi %.0f%%, %.0f x MAD, minimal %.1f ms, dikonfirmasi %d kali ulang)\n",
+                regressions, tolerance * 100.0, BENCH_NOISE_MADS, BENCH_ABSOLUTE_FLOOR * 1000.0,
+                BENCH_CONFIRM_ROUNDS);
+     }
+
+     // Written after the comparison so re-timed cases are stored with their confirming run
+     if (output_path && bench_write_json(output_path, variant, results, result_count) != 0) {
+         return 2;
+     }
+
+     return regressions > 0 ? 1 : 0;
+ }
+
+ #endif // BENCHMARK_SUITE_H
@@ -0,0 +1,101 @@
+/**
+ * cache_counter.h
+ * Hardware cache-miss counters (Linux perf_event_open) for the sorting benchmarks
+ */
+
+ #ifndef CACHE_COUNTER_H
+ #define CACHE_COUNTER_H
+
+ #include <string.h>
+
+ #ifdef __linux__
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+ #endif
+
+ typedef enum {
+     CACHE_COUNTER_L1D_MISS = 0,   // L1 data cache read misses
+     CACHE_COUNTER_LLC_MISS        // Last-level cache misses
+ } cache_counter_kind;
+
+ /**
+  * One counter for the calling process. fd is -1 when counters are unavailable
+  * (non-Linux, no PMU access in a VM or container, perf_event_paranoid too strict).
+  */
+ typedef struct {
+     int fd;
+ } cache_counter;
+
+ /**
+  * Opens a disabled counter. Returns 0 on success, -1 if it is unavailable.
+  */
+ int cache_counter_open(cache_counter *counter, cache_counter_kind kind) {
+     counter->fd = -1;
+
+ #ifdef __linux__
+     struct perf_event_attr attr;
+     memset(&attr, 0, sizeof(attr));
+     attr.size = sizeof(attr);
+     attr.disabled = 1;
+     attr.exclude_kernel = 1;
+     attr.exclude_hv = 1;
+
+     if (kind == CACHE_COUNTER_L1D_MISS) {
+         attr.type = PERF_TYPE_HW_CACHE;
+         attr.config = PERF_COUNT_HW_CACHE_L1D |
+                       (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+     } else {
+         attr.type = PERF_TYPE_HARDWARE;
+         attr.config = PERF_COUNT_HW_CACHE_MISSES;
+     }
+
+     counter->fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+ #else
+     (void)kind;
+ #endif
+
+     return counter->fd >= 0 ? 0 : -1;
+ }
+
+ void cache_counter_start(cache_counter *counter) {
+ #ifdef __linux__
+     if (counter->fd < 0) return;
+     ioctl(counter->fd, PERF_EVENT_IOC_RESET, 0);
+     ioctl(counter->fd, PERF_EVENT_IOC_ENABLE, 0);
+ #else
+     (void)counter;
+ #endif
+ }
+
+ /**
+  * Stops the counter and returns the number of events, or -1 if unavailable
+  */
+ long long cache_counter_stop(cache_counter *counter) {
+ #ifdef __linux__
+     if (counter->fd < 0) return -1;
+     ioctl(counter->fd, PERF_EVENT_IOC_DISABLE, 0);
+
+     long long value;
+     if (read(counter->fd, &value, sizeof(value)) != (ssize_t)sizeof(value)) {
+         return -1;
+     }
+     return value;
+ #else
+     (void)counter;
+     return -1;
+ #endif
+ }
+
+ void cache_counter_close(cache_counter *counter) {
+ #ifdef __linux__
+     if (counter->fd >= 0) {
+         close(counter->fd);
+     }
+ #endif
+     counter->fd = -1;
+ }
+
+ #endif // CACHE_COUNTER_H
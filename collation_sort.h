@@ -0,0 +1,178 @@
+/**
+ * collation_sort.h
+ * Locale-aware word sorting on precomputed strxfrm collation keys
+ */
+
+ #ifndef COLLATION_SORT_H
+ #define COLLATION_SORT_H
+
+ #include <locale.h>
+ #include <stdint.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include "memory_policy.h"
+
+ #define COLLATION_POOL_INITIAL (1 << 20)
+ #define COLLATION_RADIX_CUTOFF 32   // Buckets smaller than this are insertion sorted
+
+ /**
+  * A word and its collation key. strcmp on the keys gives the same order as
+  * strcoll on the words under the LC_COLLATE locale active at build time.
+  */
+ typedef struct {
+     const char *key;
+     const char *word;
+ } collation_key;
+
+ /**
+  * Keys for a set of words; every key lives in one packed buffer
+  */
+ typedef struct {
+     collation_key *keys;
+     char *buffer;
+     size_t count;
+     size_t buffer_bytes;
+ } collation_table;
+
+ /**
+  * Selects the collation locale ("" takes it from the environment).
+  * Returns the active locale name or NULL if the locale is not available.
+  */
+ const char* collation_set_locale(const char *name) {
+     return setlocale(LC_COLLATE, name);
+ }
+
+ /**
+  * Computes every word's strxfrm key once into a packed buffer.
+  * Returns 0 on success, -1 on allocation failure.
+  */
+ int collation_table_build(collation_table *table, char **words, size_t count) {
+     size_t capacity = COLLATION_POOL_INITIAL;
+     size_t used = 0;
+
+     table->keys = (collation_key *)mem_alloc(count * sizeof(collation_key), MEM_ROLE_SCRATCH);
+     table->buffer = (char *)mem_alloc(capacity, MEM_ROLE_SCRATCH);
+     if (!table->keys || !table->buffer) {
+         mem_free(table->keys);
+         mem_free(table->buffer);
+         return -1;
+     }
+
+     for (size_t i = 0; i < count; i++) {
+         size_t needed = strxfrm(table->buffer + used, words[i], capacity - used);
+
+         if (needed >= capacity - used) {
+             while (needed >= capacity - used) {
+                 capacity *= 2;
+             }
+
+             // mem_alloc has no realloc, so move the keys into a larger buffer by hand
+             char *grown = (char *)mem_alloc(capacity, MEM_ROLE_SCRATCH);
+             if (!grown) {
+                 mem_free(table->keys);
+                 mem_free(table->buffer);
+                 return -1;
+             }
+             memcpy(grown, table->buffer, used);
+             mem_free(table->buffer);
+             table->buffer = grown;
+             strxfrm(table->buffer + used, words[i], capacity - used);
+         }
+
+         // Record the offset while the buffer may still move
+         table->keys[i].key = (const char *)(uintptr_t)used;
+         table->keys[i].word = words[i];
+         used += needed + 1;
+     }
+
+     // Resolve offsets into pointers now that the buffer is final
+     for (size_t i = 0; i < count; i++) {
+         table->keys[i].key = table->buffer + (uintptr_t)table->keys[i].key;
+     }
+
+     table->count = count;
+     table->buffer_bytes = used;
+     return 0;
+ }
+
+ void collation_table_free(collation_table *table) {
+     mem_free(table->keys);
+     mem_free(table->buffer);
+     table->keys = NULL;
+     table->buffer = NULL;
+     table->count = 0;
+     table->buffer_bytes = 0;
+ }
+
+ /**
+  * Compares two collation keys; usable with any of the generic sorting algorithms
+  */
+ int compare_collation_key(const void *a, const void *b) {
+     return strcmp(((const collation_key *)a)->key, ((const collation_key *)b)->key);
+ }
+
+ /**
+  * Helper function for collation radix sort - one MSD pass on byte `depth`
+  */
+ void collation_radix_sort_recursive(collation_key *keys, collation_key *tmp, size_t n, size_t depth) {
+     if (n < COLLATION_RADIX_CUTOFF) {
+         // Every key shares its first `depth` bytes, so compare from there
+         for (size_t i = 1; i < n; i++) {
+             collation_key current = keys[i];
+             size_t j = i;
+
+             while (j > 0 && strcmp(keys[j - 1].key + depth, current.key + depth) > 0) {
+                 keys[j] = keys[j - 1];
+                 j--;
+             }
+             keys[j] = current;
+         }
+         return;
+     }
+
+     size_t count[256] = {0};
+     size_t start[256];
+
+     for (size_t i = 0; i < n; i++) {
+         count[(unsigned char)keys[i].key[depth]]++;
+     }
+
+     size_t pos = 0;
+     for (int b = 0; b < 256; b++) {
+         start[b] = pos;
+         pos += count[b];
+     }
+
+     size_t next[256];
+     memcpy(next, start, sizeof(next));
+     for (size_t i = 0; i < n; i++) {
+         tmp[next[(unsigned char)keys[i].key[depth]]++] = keys[i];
+     }
+     memcpy(keys, tmp, n * sizeof(collation_key));
+
+     // Bucket 0 holds keys that end here; they are all equal
+     for (int b = 1; b < 256; b++) {
+         if (count[b] > 1) {
+             collation_radix_sort_recursive(keys + start[b], tmp + start[b], count[b], depth + 1);
+         }
+     }
+ }
+
+ /**
+  * Collation Radix Sort
+  * MSD radix sort on the binary collation keys, one byte per pass.
+  * Complexity: O(n * key length) time, O(n) space
+  * Returns 0 on success, -1 on allocation failure.
+  */
+ int collation_radix_sort(collation_key *keys, size_t n) {
+     if (n < 2) return 0;
+
+     collation_key *tmp = (collation_key *)mem_alloc(n * sizeof(collation_key), MEM_ROLE_SCRATCH);
+     if (!tmp) return -1;
+
+     collation_radix_sort_recursive(keys, tmp, n, 0);
+     mem_free(tmp);
+     return 0;
+ }
+
+ #endif // COLLATION_SORT_H
@@ -7,7 +7,13 @@
  #include <stdlib.h>
  #include <string.h>
  #include <time.h>
+ #include "memory_policy.h"
  #include "sorting_algorithms.h"
+ #include "word_dictionary.h"
+ #include "shm_sharded_sort.h"
+ #include "collation_sort.h"
+ #include "cache_counter.h"
+ #include "benchmark_suite.h"
  
  #define MAX_WORD_LENGTH 100
  #define MAX_MEMORY_MB 100.0  // Assuming max memory usage per test
@@ -22,6 +28,11 @@
      return strcmp(*(char **)a, *(char **)b);
  }
  
+ // Function to compare strings with the locale's collation order
+ int compare_string_coll(const void *a, const void *b) {
+     return strcoll(*(char **)a, *(char **)b);
+ }
+ 
  // Function to print divider line
  void print_divider(int width) {
      for (int i = 0; i < width; i++) {
@@ -44,7 +55,7 @@
          return NULL;
      }
      
-     int *data = malloc(count * sizeof(int));
+     int *data = mem_alloc(count * sizeof(int), MEM_ROLE_SHARED);
      if (!data) {
          perror("Memory allocation failed");
          fclose(file);
@@ -58,7 +69,7 @@
                  break;
              } else {
                  perror("Error reading from file");
-                 free(data);
+                 mem_free(data);
                  fclose(file);
                  return NULL;
              }
@@ -69,6 +80,13 @@
      return data;
  }
  
+ // Free string array. Sorting moves the word pointers around, so the word block
+ // is found through the hidden slot array[count] instead of array[0].
+ void free_string_array(char **array, size_t count) {
+     mem_free(array[count]);
+     mem_free(array);
+ }
+ 
  // Load string data from file
  char** load_string_data(const char *filename, size_t count) {
      FILE *file = fopen(filename, "r");
@@ -77,39 +95,32 @@
          return NULL;
      }
      
-     char **data = malloc(count * sizeof(char*));
-     if (!data) {
+     // All words share one block so it can be placed as a whole; its base is kept
+     // in the extra slot data[count], which the sorts never touch
+     char **data = mem_alloc((count + 1) * sizeof(char*), MEM_ROLE_SHARED);
+     char *words = mem_alloc(count * MAX_WORD_LENGTH * sizeof(char), MEM_ROLE_SHARED);
+     if (!data || !words) {
          perror("Memory allocation failed");
+         mem_free(data);
+         mem_free(words);
          fclose(file);
          return NULL;
      }
      
+     data[count] = words;
+     for (size_t i = 0; i < count; i++) {
+         data[i] = words + i * MAX_WORD_LENGTH;
+         data[i][0] = '\0';
+     }
+     
      for (size_t i = 0; i < count; i++) {
-         data[i] = malloc(MAX_WORD_LENGTH * sizeof(char));
-         if (!data[i]) {
-             perror("Memory allocation failed");
-             
-             // Free previously allocated memory
-             for (size_t j = 0; j < i; j++) {
-                 free(data[j]);
-             }
-             free(data);
-             fclose(file);
-             return NULL;
-         }
-         
          if (fscanf(file, "%s", data[i]) != 1) {
              if (feof(file)) {
                  printf("Warning: End of file reached after reading %zu words\n", i);
                  break;
              } else {
                  perror("Error reading from file");
-                 
-                 // Free previously allocated memory
-                 for (size_t j = 0; j <= i; j++) {
-                     free(data[j]);
-                 }
-                 free(data);
+                 free_string_array(data, count);
                  fclose(file);
                  return NULL;
              }
@@ -122,7 +133,7 @@
  
  // Function to duplicate integer array for testing
  int* duplicate_int_array(int *source, size_t count) {
-     int *dest = malloc(count * sizeof(int));
+     int *dest = mem_alloc(count * sizeof(int), MEM_ROLE_SCRATCH);
      if (dest) {
          memcpy(dest, source, count * sizeof(int));
      }
@@ -131,34 +142,23 @@
  
  // Function to duplicate string array for testing
  char** duplicate_string_array(char **source, size_t count) {
-     char **dest = malloc(count * sizeof(char*));
-     if (!dest) return NULL;
+     char **dest = mem_alloc((count + 1) * sizeof(char*), MEM_ROLE_SCRATCH);
+     char *words = mem_alloc(count * MAX_WORD_LENGTH * sizeof(char), MEM_ROLE_SCRATCH);
+     if (!dest || !words) {
+         mem_free(dest);
+         mem_free(words);
+         return NULL;
+     }
      
+     dest[count] = words;
      for (size_t i = 0; i < count; i++) {
-         dest[i] = malloc(MAX_WORD_LENGTH * sizeof(char));
-         if (!dest[i]) {
-             // Free previously allocated memory
-             for (size_t j = 0; j < i; j++) {
-                 free(dest[j]);
-             }
-             free(dest);
-             return NULL;
-         }
-         
+         dest[i] = words + i * MAX_WORD_LENGTH;
          strcpy(dest[i], source[i]);
      }
      
      return dest;
  }
  
- // Free string array
- void free_string_array(char **array, size_t count) {
-     for (size_t i = 0; i < count; i++) {
-         free(array[i]);
-     }
-     free(array);
- }
- 
  // Test sorting algorithm with integer data and display results in table format
  void test_int_sort(const char *algo_name, void (*sort_func)(void*, size_t, size_t, int(*)(const void*, const void*)), 
                     int *data, size_t count) {
@@ -192,7 +192,7 @@
          printf("| %-15s | %-10zu | %-20.3f | %-10.2f |\n", algo_name, count, cpu_time_used, memory_mb);
      }
      
-     free(test_data);
+     mem_free(test_data);
  }
  
  // Test sorting algorithm with string data and display results in table format
@@ -231,6 +231,398 @@
      free_string_array(test_data, count);
  }
  
+ // Compare dictionary-encoded sorting (unique keys only) against Quick Sort on the raw word array
+ void test_dictionary_sort(char **data, size_t count) {
+     printf("\n=== Hasil Dictionary Sort Data Kata ===\n");
+     printf("| %-28s | %-10s | %-20s |\n", "Tahap", "Jumlah Data", "Waktu Eksekusi");
+     print_divider(68);
+ 
+     // Baseline: Quick Sort on a private copy of the raw char** array
+     char **raw_data = duplicate_string_array(data, count);
+     if (!raw_data) {
+         printf("| %-28s | %-10zu | %-20s |\n", "Quick Sort (raw)", count, "Memory allocation failed");
+         return;
+     }
+ 
+     clock_t start = clock();
+     quick_sort(raw_data, count, sizeof(char*), compare_string);
+     clock_t end = clock();
+     double raw_time = ((double) (end - start)) / CLOCKS_PER_SEC;
+     printf("| %-28s | %-10zu | %-20.3f |\n", "Quick Sort (raw)", count, raw_time);
+ 
+     // Dictionary mode: intern, sort unique keys, expand back to one entry per occurrence
+     word_dictionary dict;
+     start = clock();
+     int build_status = word_dictionary_build(&dict, data, count);
+     end = clock();
+     double build_time = ((double) (end - start)) / CLOCKS_PER_SEC;
+ 
+     if (build_status != 0) {
+         printf("| %-28s | %-10zu | %-20s |\n", "Build dictionary", count, "Memory allocation failed");
+         free_string_array(raw_data, count);
+         return;
+     }
+     printf("| %-28s | %-10zu | %-20.3f |\n", "Build dictionary", count, build_time);
+ 
+     start = clock();
+     word_run *runs = word_dictionary_sorted_runs(&dict, quick_sort);
+     end = clock();
+     double sort_time = ((double) (end - start)) / CLOCKS_PER_SEC;
+ 
+     const char **expanded = mem_alloc(count * sizeof(char*), MEM_ROLE_SCRATCH);
+     if (!runs || !expanded) {
+         printf("| %-28s | %-10zu | %-20s |\n", "Sort unique keys", dict.unique_count, "Memory allocation failed");
+         free(runs);
+         mem_free(expanded);
+         word_dictionary_free(&dict);
+         free_string_array(raw_data, count);
+         return;
+     }
+     printf("| %-28s | %-10zu | %-20.3f |\n", "Sort unique keys", dict.unique_count, sort_time);
+ 
+     start = clock();
+     size_t expanded_count = word_runs_expand(runs, dict.unique_count, expanded);
+     end = clock();
+     double expand_time = ((double) (end - start)) / CLOCKS_PER_SEC;
+     printf("| %-28s | %-10zu | %-20.3f |\n", "Expand runs", expanded_count, expand_time);
+ 
+     double dict_time = build_time + sort_time + expand_time;
+     printf("| %-28s | %-10zu | %-20.3f |\n", "Dictionary total", count, dict_time);
+     print_divider(68);
+ 
+     // The expanded output must match the raw Quick Sort result position by position
+     int is_equal = (expanded_count == count);
+     for (size_t i = 0; is_equal && i < count; i++) {
+         if (strcmp(expanded[i], raw_data[i]) != 0) {
+             is_equal = 0;
+         }
+     }
+ 
+     double unique_ratio = count ? (double) dict.unique_count / count : 0.0;
+     printf("Kata unik        : %zu dari %zu (rasio %.4f)\n", dict.unique_count, count, unique_ratio);
+     printf("Hasil sama       : %s\n", is_equal ? "Ya" : "Tidak");
+     if (dict_time > 0.0) {
+         printf("Speedup          : %.2fx terhadap Quick Sort (raw)\n", raw_time / dict_time);
+     } else {
+         printf("Speedup          : -\n");
+     }
+ 
+     mem_free(expanded);
+     free(runs);
+     word_dictionary_free(&dict);
+     free_string_array(raw_data, count);
+ }
+ 
+ // Let the user pick one of the O(n log n) algorithms; returns NULL on an invalid choice
+ void (*select_nlogn_algorithm(const char *prompt, const char **algo_name))(void*, size_t, size_t, int(*)(const void*, const void*)) {
+     printf("\n%s:\n", prompt);
+     printf("4. Merge Sort\n");
+     printf("5. Quick Sort\n");
+     printf("6. Shell Sort\n");
+     printf("Pilihan Anda: ");
+ 
+     int algo_choice;
+     scanf("%d", &algo_choice);
+ 
+     switch (algo_choice) {
+         case 4: *algo_name = "Merge Sort"; return merge_sort;
+         case 5: *algo_name = "Quick Sort"; return quick_sort;
+         case 6: *algo_name = "Shell Sort"; return shell_sort;
+     }
+ 
+     printf("Pilihan tidak valid!\n");
+     return NULL;
+ }
+ 
+ // Compare the multi-process sharded sort against the same algorithm in a single process
+ void test_sharded_sort(int data_type, int *int_data, char **string_data, size_t count) {
+     if (!SHARDED_SORT_SUPPORTED) {
+         printf("Sharded sort membutuhkan fork() dan shm_open(), tidak didukung di sistem ini.\n");
+         return;
+     }
+ 
+     const char *algo_name;
+     void (*sort_func)(void*, size_t, size_t, int(*)(const void*, const void*));
+     sort_func = select_nlogn_algorithm("Pilih algoritma per shard", &algo_name);
+     if (!sort_func) return;
+ 
+     printf("Jumlah proses worker (1-%d): ", SHARD_MAX_WORKERS);
+     int workers;
+     scanf("%d", &workers);
+     if (workers < 1 || workers > SHARD_MAX_WORKERS) {
+         printf("Pilihan tidak valid!\n");
+         return;
+     }
+ 
+     size_t elem_size = (data_type == 1) ? sizeof(int) : sizeof(char*);
+     int (*compare)(const void*, const void*) = (data_type == 1) ? compare_int : compare_string;
+ 
+     // Two private copies: one for the single-process baseline, one for the sharded run
+     void *single_data = (data_type == 1) ? (void *)duplicate_int_array(int_data, count)
+                                          : (void *)duplicate_string_array(string_data, count);
+     void *sharded_data = (data_type == 1) ? (void *)duplicate_int_array(int_data, count)
+                                           : (void *)duplicate_string_array(string_data, count);
+ 
+     printf("\n=== Hasil Sharded Sort Data %s (%s, %d proses) ===\n",
+            data_type == 1 ? "Angka" : "Kata", algo_name, workers);
+ 
+     if (!single_data || !sharded_data) {
+         printf("Memory allocation failed\n");
+     } else {
+         double start = shard_wall_time();
+         sort_func(single_data, count, elem_size, compare);
+         double single_time = shard_wall_time() - start;
+ 
+         shard_stats stats;
+         int status = (data_type == 1)
+             ? sharded_sort(sharded_data, count, elem_size, compare, sort_func, workers, &stats)
+             : sharded_sort_strings(sharded_data, count, compare, sort_func, workers, &stats);
+ 
+         printf("| %-28s | %-10s | %-20s |\n", "Tahap", "Jumlah Data", "Waktu (wall, s)");
+         print_divider(68);
+         printf("| %-28s | %-10zu | %-20.3f |\n", "Single-process", count, single_time);
+ 
+         if (status != 0) {
+             printf("| %-28s | %-10zu | %-20s |\n", "Sharded total", count, "Gagal");
+         } else {
+             printf("| %-28s | %-10zu | %-20.3f |\n", "Partisi (splitter)", count, stats.partition_time);
+             printf("| %-28s | %-10zu | %-20.3f |\n", "Sort shard (worker)", count, stats.sort_time);
+             printf("| %-28s | %-10zu | %-20.3f |\n", "Sharded total", count, stats.total_time);
+             print_divider(68);
+ 
+             // Both runs must produce the same order
+             int is_equal = 1;
+             for (size_t i = 0; is_equal && i < count; i++) {
+                 if (data_type == 1) {
+                     is_equal = ((int *)single_data)[i] == ((int *)sharded_data)[i];
+                 } else {
+                     is_equal = strcmp(((char **)single_data)[i], ((char **)sharded_data)[i]) == 0;
+                 }
+             }
+ 
+             size_t largest = 0;
+             for (int s = 0; s < stats.workers; s++) {
+                 if (stats.shard_sizes[s] > largest) largest = stats.shard_sizes[s];
+             }
+ 
+             printf("Shard terbesar   : %zu elemen (ideal %zu)\n", largest, count / stats.workers);
+             printf("Shard diulang    : %d (worker di-kill karena hang: %d, diurutkan coordinator: %d)\n",
+                    stats.retried_shards, stats.killed_workers, stats.local_shards);
+             printf("Hasil sama       : %s\n", is_equal ? "Ya" : "Tidak");
+             if (stats.total_time > 0.0) {
+                 printf("Speedup          : %.2fx terhadap single-process\n", single_time / stats.total_time);
+             }
+         }
+     }
+ 
+     if (data_type == 1) {
+         mem_free(single_data);
+         mem_free(sharded_data);
+     } else {
+         if (single_data) free_string_array(single_data, count);
+         if (sharded_data) free_string_array(sharded_data, count);
+     }
+ }
+ 
+ // Check that words are in non-decreasing strcoll order
+ int is_collation_sorted(const char **words, size_t count) {
+     for (size_t i = 1; i < count; i++) {
+         if (strcoll(words[i - 1], words[i]) > 0) {
+             return 0;
+         }
+     }
+     return 1;
+ }
+ 
+ // Compare sorting on precomputed collation keys against strcoll per comparison and plain strcmp
+ void test_collation_sort(char **data, size_t count) {
+     const char *algo_name;
+     void (*sort_func)(void*, size_t, size_t, int(*)(const void*, const void*));
+     sort_func = select_nlogn_algorithm("Pilih algoritma untuk kunci kolasi", &algo_name);
+     if (!sort_func) return;
+ 
+     const char *locale_name = collation_set_locale("");
+     if (!locale_name) {
+         printf("Locale dari environment tidak tersedia, memakai \"C\".\n");
+         locale_name = collation_set_locale("C");
+     }
+ 
+     printf("\n=== Hasil Collation Sort Data Kata (LC_COLLATE=%s) ===\n", locale_name);
+     printf("| %-28s | %-10s | %-20s | %-10s |\n", "Metode", "Jumlah Data", "Waktu Eksekusi", "Urutan");
+     print_divider(81);
+ 
+     // Plain strcmp: fast but ignores the locale
+     char **test_data = duplicate_string_array(data, count);
+     if (!test_data) {
+         printf("| %-28s | %-10zu | %-20s | %-10s |\n", "strcmp", count, "Memory allocation failed", "-");
+         return;
+     }
+     clock_t start = clock();
+     sort_func(test_data, count, sizeof(char*), compare_string);
+     clock_t end = clock();
+     double strcmp_time = ((double) (end - start)) / CLOCKS_PER_SEC;
+     printf("| %-28s | %-10zu | %-20.3f | %-10s |\n", "strcmp", count, strcmp_time,
+            is_collation_sorted((const char **)test_data, count) ? "OK" : "Beda");
+     free_string_array(test_data, count);
+ 
+     // strcoll on every comparison
+     test_data = duplicate_string_array(data, count);
+     if (!test_data) {
+         printf("| %-28s | %-10zu | %-20s | %-10s |\n", "strcoll", count, "Memory allocation failed", "-");
+         return;
+     }
+     start = clock();
+     sort_func(test_data, count, sizeof(char*), compare_string_coll);
+     end = clock();
+     double strcoll_time = ((double) (end - start)) / CLOCKS_PER_SEC;
+     printf("| %-28s | %-10zu | %-20.3f | %-10s |\n", "strcoll", count, strcoll_time,
+            is_collation_sorted((const char **)test_data, count) ? "OK" : "Salah");
+     free_string_array(test_data, count);
+ 
+     // Collation keys computed once, then sorted with the chosen algorithm and with radix sort
+     collation_table table;
+     start = clock();
+     int build_status = collation_table_build(&table, data, count);
+     end = clock();
+     double build_time = ((double) (end - start)) / CLOCKS_PER_SEC;
+     if (build_status != 0) {
+         printf("| %-28s | %-10zu | %-20s | %-10s |\n", "strxfrm keys", count, "Memory allocation failed", "-");
+         return;
+     }
+     printf("| %-28s | %-10zu | %-20.3f | %-10s |\n", "strxfrm keys (build)", count, build_time, "-");
+ 
+     const char **sorted_words = mem_alloc(count * sizeof(char*), MEM_ROLE_SCRATCH);
+     collation_key *radix_keys = mem_alloc(count * sizeof(collation_key), MEM_ROLE_SCRATCH);
+     if (!sorted_words || !radix_keys) {
+         printf("Memory allocation failed\n");
+         mem_free(sorted_words);
+         mem_free(radix_keys);
+         collation_table_free(&table);
+         return;
+     }
+     memcpy(radix_keys, table.keys, count * sizeof(collation_key));
+ 
+     start = clock();
+     sort_func(table.keys, count, sizeof(collation_key), compare_collation_key);
+     end = clock();
+     double key_sort_time = ((double) (end - start)) / CLOCKS_PER_SEC;
+     for (size_t i = 0; i < count; i++) {
+         sorted_words[i] = table.keys[i].word;
+     }
+     char label[64];
+     snprintf(label, sizeof(label), "strxfrm keys + %s", algo_name);
+     printf("| %-28s | %-10zu | %-20.3f | %-10s |\n", label, count, build_time + key_sort_time,
+            is_collation_sorted(sorted_words, count) ? "OK" : "Salah");
+ 
+     start = clock();
+     int radix_status = collation_radix_sort(radix_keys, count);
+     end = clock();
+     double radix_time = ((double) (end - start)) / CLOCKS_PER_SEC;
+     if (radix_status != 0) {
+         printf("| %-28s | %-10zu | %-20s | %-10s |\n", "strxfrm keys + Radix Sort", count, "Memory allocation failed", "-");
+     } else {
+         for (size_t i = 0; i < count; i++) {
+             sorted_words[i] = radix_keys[i].word;
+         }
+         printf("| %-28s | %-10zu | %-20.3f | %-10s |\n", "strxfrm keys + Radix Sort", count, build_time + radix_time,
+                is_collation_sorted(sorted_words, count) ? "OK" : "Salah");
+     }
+     print_divider(81);
+ 
+     printf("Ukuran buffer kunci: %.2f MB\n", table.buffer_bytes / (1024.0 * 1024.0));
+     if (build_time + key_sort_time > 0.0) {
+         printf("Speedup kunci kolasi terhadap strcoll: %.2fx\n", strcoll_time / (build_time + key_sort_time));
+     }
+ 
+     mem_free(sorted_words);
+     mem_free(radix_keys);
+     collation_table_free(&table);
+ }
+ 
+ // Format a cache-miss count, or "-" when the counter is unavailable
+ void format_miss_count(char *buffer, size_t length, long long misses) {
+     if (misses < 0) {
+         snprintf(buffer, length, "-");
+     } else {
+         snprintf(buffer, length, "%lld", misses);
+     }
+ }
+ 
+ // Time one sort and count its cache misses on a private copy of the data
+ void benchmark_cache_row(const char *algo_name, void (*sort_func)(void*, size_t, size_t, int(*)(const void*, const void*)),
+                          int data_type, int *int_data, char **string_data, size_t count) {
+     size_t elem_size = (data_type == 1) ? sizeof(int) : sizeof(char*);
+     int (*compare)(const void*, const void*) = (data_type == 1) ? compare_int : compare_string;
+     void *test_data = (data_type == 1) ? (void *)duplicate_int_array(int_data, count)
+                                        : (void *)duplicate_string_array(string_data, count);
+     if (!test_data) {
+         printf("| %-22s | %-10zu | %-14s | %-14s | %-14s |\n", algo_name, count, "Memory alloc", "-", "-");
+         return;
+     }
+ 
+     cache_counter l1d, llc;
+     cache_counter_open(&l1d, CACHE_COUNTER_L1D_MISS);
+     cache_counter_open(&llc, CACHE_COUNTER_LLC_MISS);
+ 
+     cache_counter_start(&l1d);
+     cache_counter_start(&llc);
+     clock_t start = clock();
+     sort_func(test_data, count, elem_size, compare);
+     clock_t end = clock();
+     long long l1d_misses = cache_counter_stop(&l1d);
+     long long llc_misses = cache_counter_stop(&llc);
+ 
+     cache_counter_close(&l1d);
+     cache_counter_close(&llc);
+ 
+     double cpu_time_used = ((double) (end - start)) / CLOCKS_PER_SEC;
+ 
+     // Check if sorting was successful
+     int is_sorted = 1;
+     for (size_t i = 1; i < count; i++) {
+         if (compare((unsigned char *)test_data + i * elem_size, (unsigned char *)test_data + (i - 1) * elem_size) < 0) {
+             is_sorted = 0;
+             break;
+         }
+     }
+ 
+     char l1d_text[32], llc_text[32];
+     format_miss_count(l1d_text, sizeof(l1d_text), l1d_misses);
+     format_miss_count(llc_text, sizeof(llc_text), llc_misses);
+ 
+     if (!is_sorted) {
+         printf("| %-22s | %-10zu | %-14s | %-14s | %-14s |\n", algo_name, count, "Not sorted", l1d_text, llc_text);
+     } else {
+         printf("| %-22s | %-10zu | %-14.3f | %-14s | %-14s |\n", algo_name, count, cpu_time_used, l1d_text, llc_text);
+     }
+ 
+     if (data_type == 1) {
+         mem_free(test_data);
+     } else {
+         free_string_array(test_data, count);
+     }
+ }
+ 
+ // Compare the bottom-up merge engine with Merge Sort and Shell Sort at every dataset size
+ void run_cache_benchmark(int data_type, int *int_data, char **string_data, const size_t *sizes, size_t size_count) {
+     printf("\n=== Benchmark Cache Data %s ===\n", data_type == 1 ? "Angka" : "Kata");
+     printf("| %-22s | %-10s | %-14s | %-14s | %-14s |\n", "Algoritma", "Jumlah Data", "Waktu (s)", "L1D Miss", "LLC Miss");
+     print_divider(92);
+ 
+     for (size_t i = 0; i < size_count; i++) {
+         benchmark_cache_row("Merge Sort", merge_sort, data_type, int_data, string_data, sizes[i]);
+         benchmark_cache_row("Shell Sort", shell_sort, data_type, int_data, string_data, sizes[i]);
+         benchmark_cache_row("Bottom-Up Merge Sort", merge_sort_bottom_up, data_type, int_data, string_data, sizes[i]);
+         print_divider(92);
+     }
+ 
+     cache_counter probe;
+     if (cache_counter_open(&probe, CACHE_COUNTER_LLC_MISS) != 0) {
+         printf("Counter cache tidak tersedia (butuh Linux perf_event dan akses PMU).\n");
+     }
+     cache_counter_close(&probe);
+ }
+ 
  // Run tests for a specific algorithm, data type, and dataset size
  void run_specific_test(int algo_choice, int data_type, int *int_data, char **string_data, size_t count) {
      if (data_type == 1) { // Integer data
@@ -238,6 +630,7 @@
      } else { // String data
          printf("\n=== Hasil Sorting Data Kata ===\n");
      }
+     mem_print_status();
      
      print_table_header();
      
@@ -302,9 +695,41 @@
      }
  }
  
- int main() {
+ // Let the user pick the placement policy for per-test copies and sort scratch buffers
+ void select_memory_policy() {
+     printf("\n");
+     mem_print_status();
+     printf("Kebijakan data bersama hanya dapat diubah lewat SORT_MEM_SHARED sebelum program dijalankan.\n");
+     printf("\nPilih kebijakan memori scratch:\n");
+     for (int i = 0; i < MEM_POLICY_COUNT; i++) {
+         printf("%d. %s\n", i + 1, mem_policy_name((mem_policy)i));
+     }
+     printf("Pilihan Anda: ");
+     
+     int policy_choice;
+     scanf("%d", &policy_choice);
+     
+     if (policy_choice < 1 || policy_choice > MEM_POLICY_COUNT) {
+         printf("Pilihan tidak valid!\n");
+         return;
+     }
+     
+     mem_set_policy(MEM_ROLE_SCRATCH, (mem_policy)(policy_choice - 1));
+     mem_print_status();
+ }
+ 
+ int main(int argc, char *argv[]) {
+     mem_policy_init_from_env();
+     
+     // Non-interactive regression suite used by `make bench`
+     if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+         return run_benchmark_suite(argc, argv);
+     }
+     
      printf("\n=== Sorting Algorithm Performance Analysis ===\n\n");
      
+     mem_print_status();
+     
      // Dataset sizes to test
      size_t test_sizes[] = {10000, 50000, 100000, 250000, 500000, 1000000, 1500000, 2000000};
      
@@ -316,7 +741,7 @@
      if (!full_int_data || !full_string_data) {
          printf("Failed to load dataset. Make sure the files exist and are readable.\n");
          
-         if (full_int_data) free(full_int_data);
+         if (full_int_data) mem_free(full_int_data);
          if (full_string_data) free_string_array(full_string_data, 2000000);
          
          return 1;
@@ -336,6 +761,11 @@
          printf("5. Quick Sort\n");
          printf("6. Shell Sort\n");
          printf("7. Semua Algoritma\n");
+         printf("8. Dictionary Sort (khusus Data Kata)\n");
+         printf("9. Atur Kebijakan Memori\n");
+         printf("10. Sharded Multi-Process Sort\n");
+         printf("11. Collation Sort (khusus Data Kata)\n");
+         printf("12. Benchmark Cache Bottom-Up Merge Sort\n");
          printf("0. Keluar\n");
          printf("Pilihan Anda: ");
          
@@ -346,25 +776,44 @@
              break;
          }
          
-         if (algo_choice < 0 || algo_choice > 7) {
+         if (algo_choice < 0 || algo_choice > 12) {
              printf("Pilihan tidak valid!\n");
              continue;
          }
          
-         // Menu for data type selection
-         printf("\nPilih jenis data:\n");
-         printf("1. Data Angka\n");
-         printf("2. Data Kata\n");
-         printf("Pilihan Anda: ");
+         if (algo_choice == 9) {
+             select_memory_policy();
+             continue;
+         }
          
          int data_type;
-         scanf("%d", &data_type);
+         if (algo_choice == 8 || algo_choice == 11) {
+             // Dictionary and collation modes only apply to word data
+             data_type = 2;
+         } else {
+             // Menu for data type selection
+             printf("\nPilih jenis data:\n");
+             printf("1. Data Angka\n");
+             printf("2. Data Kata\n");
+             printf("Pilihan Anda: ");
+             
+             scanf("%d", &data_type);
+         }
          
          if (data_type != 1 && data_type != 2) {
              printf("Pilihan tidak valid!\n");
              continue;
          }
          
+         if (algo_choice == 12) {
+             // The cache benchmark walks every dataset size itself
+             run_cache_benchmark(data_type, full_int_data, full_string_data, test_sizes, sizeof(test_sizes) / sizeof(test_sizes[0]));
+             
+             printf("\nIngin menjalankan program lagi? (1: Ya, 0: Tidak): ");
+             scanf("%d", &continue_program);
+             continue;
+         }
+         
     
         // Replace the manual data size input with a menu
 
@@ -406,14 +855,22 @@
             }
         }
          
-         run_specific_test(algo_choice, data_type, full_int_data, full_string_data, data_size);
+         if (algo_choice == 8) {
+             test_dictionary_sort(full_string_data, data_size);
+         } else if (algo_choice == 10) {
+             test_sharded_sort(data_type, full_int_data, full_string_data, data_size);
+         } else if (algo_choice == 11) {
+             test_collation_sort(full_string_data, data_size);
+         } else {
+             run_specific_test(algo_choice, data_type, full_int_data, full_string_data, data_size);
+         }
          
          printf("\nIngin menjalankan program lagi? (1: Ya, 0: Tidak): ");
          scanf("%d", &continue_program);
      }
      
      // Clean up
-     free(full_int_data);
+     mem_free(full_int_data);
      free_string_array(full_string_data, 2000000);
      
      printf("\nProgram selesai. Terima kasih!\n");
@@ -0,0 +1,270 @@
+/**
+ * memory_policy.h
+ * Allocation layer for data arrays and sort scratch space with selectable
+ * huge-page and NUMA placement policies
+ */
+
+ #ifndef MEMORY_POLICY_H
+ #define MEMORY_POLICY_H
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+
+ #ifdef __linux__
+ #include <sys/mman.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+ #endif
+
+ #define MEM_HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+ #define MEM_HEADER_SIZE 64   // One cache line; the buffer behind it starts on the next line
+ #define MEM_MAX_NODES 1024
+
+ #ifndef MPOL_INTERLEAVE
+ #define MPOL_INTERLEAVE 3
+ #endif
+ #ifndef MPOL_LOCAL
+ #define MPOL_LOCAL 4
+ #endif
+ #ifndef MPOL_F_MEMS_ALLOWED
+ #define MPOL_F_MEMS_ALLOWED (1 << 2)
+ #endif
+
+ /**
+  * Placement policies. Everything except MEM_POLICY_MALLOC only applies to
+  * buffers of at least one huge page; smaller requests always use malloc.
+  */
+ typedef enum {
+     MEM_POLICY_MALLOC = 0,     // Plain malloc
+     MEM_POLICY_THP,            // 2 MB aligned mmap + madvise(MADV_HUGEPAGE)
+     MEM_POLICY_HUGETLB,        // Explicit MAP_HUGETLB pages, falls back to THP
+     MEM_POLICY_FIRST_TOUCH,    // Pages placed on the node of the thread that touches them first
+     MEM_POLICY_INTERLEAVE,     // Pages interleaved across all allowed nodes
+     MEM_POLICY_COUNT
+ } mem_policy;
+
+ /**
+  * What a buffer is used for. Each role has its own policy so shared datasets
+  * and per-sort scratch space can be tuned independently.
+  */
+ typedef enum {
+     MEM_ROLE_SHARED = 0,       // Loaded datasets read by every test
+     MEM_ROLE_SCRATCH,          // Per-test copies and sort scratch buffers
+     MEM_ROLE_COUNT
+ } mem_role;
+
+ typedef enum {
+     MEM_KIND_MALLOC = 0,
+     MEM_KIND_MMAP
+ } mem_kind;
+
+ /**
+  * Bookkeeping stored in front of every buffer handed out by mem_alloc
+  */
+ typedef struct {
+     void *base;
+     size_t length;
+     int kind;
+ } mem_header;
+
+ static const char *mem_policy_names[MEM_POLICY_COUNT] = {
+     "malloc", "thp", "hugetlb", "first-touch", "interleave"
+ };
+
+ static mem_policy mem_policies[MEM_ROLE_COUNT] = { MEM_POLICY_MALLOC, MEM_POLICY_MALLOC };
+ static size_t mem_hugetlb_fallbacks = 0;
+ static size_t mem_numa_failures = 0;
+
+ /**
+  * Parses a policy name. Returns the policy or -1 if the name is unknown.
+  */
+ int mem_policy_from_name(const char *name) {
+     for (int i = 0; i < MEM_POLICY_COUNT; i++) {
+         if (strcmp(name, mem_policy_names[i]) == 0) {
+             return i;
+         }
+     }
+     return -1;
+ }
+
+ const char* mem_policy_name(mem_policy policy) {
+     return (policy >= 0 && policy < MEM_POLICY_COUNT) ? mem_policy_names[policy] : "unknown";
+ }
+
+ void mem_set_policy(mem_role role, mem_policy policy) {
+     mem_policies[role] = policy;
+ }
+
+ mem_policy mem_get_policy(mem_role role) {
+     return mem_policies[role];
+ }
+
+ /**
+  * Reads SORT_MEM_SHARED and SORT_MEM_SCRATCH from the environment
+  */
+ void mem_policy_init_from_env(void) {
+     const char *vars[MEM_ROLE_COUNT] = { "SORT_MEM_SHARED", "SORT_MEM_SCRATCH" };
+
+     for (int role = 0; role < MEM_ROLE_COUNT; role++) {
+         const char *value = getenv(vars[role]);
+         if (!value) continue;
+
+         int policy = mem_policy_from_name(value);
+         if (policy < 0) {
+             printf("Warning: unknown memory policy '%s' in %s, using malloc\n", value, vars[role]);
+             continue;
+         }
+         mem_policies[role] = (mem_policy)policy;
+     }
+ }
+
+ #ifdef __linux__
+ /**
+  * Applies a NUMA policy to a mapping through the raw mbind syscall so no
+  * libnuma dependency is needed. Single-node machines simply accept it.
+  */
+ int mem_apply_numa_policy(void *addr, size_t length, mem_policy policy) {
+ #if defined(SYS_mbind) && defined(SYS_get_mempolicy)
+     unsigned long nodemask[MEM_MAX_NODES / (8 * sizeof(unsigned long))];
+     memset(nodemask, 0, sizeof(nodemask));
+
+     if (policy == MEM_POLICY_INTERLEAVE) {
+         int mode;
+         if (syscall(SYS_get_mempolicy, &mode, nodemask, MEM_MAX_NODES, NULL, MPOL_F_MEMS_ALLOWED) != 0) {
+             return -1;
+         }
+         return (int)syscall(SYS_mbind, addr, length, MPOL_INTERLEAVE, nodemask, MEM_MAX_NODES, 0);
+     }
+
+     // MPOL_LOCAL: allocate on the node of the CPU that first touches the page
+     return (int)syscall(SYS_mbind, addr, length, MPOL_LOCAL, NULL, 0, 0);
+ #else
+     (void)addr;
+     (void)length;
+     (void)policy;
+     return -1;
+ #endif
+ }
+
+ /**
+  * Maps length bytes with the requested policy. Returns the mapping or NULL.
+  */
+ void* mem_map(size_t length, mem_policy policy, size_t *mapped_length) {
+     void *base;
+
+     if (policy == MEM_POLICY_HUGETLB) {
+ #ifdef MAP_HUGETLB
+         size_t huge_length = (length + MEM_HUGE_PAGE_SIZE - 1) & ~(MEM_HUGE_PAGE_SIZE - 1);
+         base = mmap(NULL, huge_length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+         if (base != MAP_FAILED) {
+             *mapped_length = huge_length;
+             return base;
+         }
+ #endif
+         // No reserved huge pages: fall back to transparent huge pages
+         mem_hugetlb_fallbacks++;
+         policy = MEM_POLICY_THP;
+     }
+ 
+     // munmap only accepts page-aligned ranges, so trim and free whole pages
+     size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+     length = (length + page_size - 1) & ~(page_size - 1);
+
+     // Over-map by one huge page so the region can be trimmed to a 2 MB boundary
+     size_t padded = length + MEM_HUGE_PAGE_SIZE;
+     unsigned char *raw = (unsigned char *)mmap(NULL, padded, PROT_READ | PROT_WRITE,
+                                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+     if (raw == (unsigned char *)MAP_FAILED) return NULL;
+
+     size_t misalign = (size_t)raw & (MEM_HUGE_PAGE_SIZE - 1);
+     size_t head = misalign ? MEM_HUGE_PAGE_SIZE - misalign : 0;
+     size_t tail = padded - head - length;
+     if (head) munmap(raw, head);
+     if (tail) munmap(raw + head + length, tail);
+     base = raw + head;
+
+     if (policy == MEM_POLICY_THP) {
+ #ifdef MADV_HUGEPAGE
+         madvise(base, length, MADV_HUGEPAGE);
+ #endif
+     } else if (policy == MEM_POLICY_FIRST_TOUCH || policy == MEM_POLICY_INTERLEAVE) {
+         if (mem_apply_numa_policy(base, length, policy) != 0) {
+             mem_numa_failures++;
+         }
+ #ifdef MADV_HUGEPAGE
+         madvise(base, length, MADV_HUGEPAGE);
+ #endif
+     }
+
+     *mapped_length = length;
+     return base;
+ }
+ #endif // __linux__
+
+ /**
+  * Allocates size bytes for the given role. Release with mem_free.
+  * Returns NULL on failure, like malloc.
+  */
+ void* mem_alloc(size_t size, mem_role role) {
+     size_t total = size + MEM_HEADER_SIZE;
+     mem_policy policy = mem_policies[role];
+     mem_header *header;
+
+ #ifdef __linux__
+     if (policy != MEM_POLICY_MALLOC && total >= MEM_HUGE_PAGE_SIZE) {
+         size_t mapped_length;
+         void *base = mem_map(total, policy, &mapped_length);
+         if (base) {
+             header = (mem_header *)base;
+             header->base = base;
+             header->length = mapped_length;
+             header->kind = MEM_KIND_MMAP;
+             return (unsigned char *)base + MEM_HEADER_SIZE;
+         }
+     }
+ #else
+     (void)policy;
+ #endif
+
+     // malloc only guarantees 16 bytes; align the block so the buffer behind the header is too
+     void *base;
+     if (posix_memalign(&base, MEM_HEADER_SIZE, total) != 0) return NULL;
+
+     header = (mem_header *)base;
+     header->base = base;
+     header->length = total;
+     header->kind = MEM_KIND_MALLOC;
+     return (unsigned char *)base + MEM_HEADER_SIZE;
+ }
+
+ /**
+  * Releases a buffer returned by mem_alloc. NULL is ignored.
+  */
+ void mem_free(void *ptr) {
+     if (!ptr) return;
+
+     mem_header *header = (mem_header *)((unsigned char *)ptr - MEM_HEADER_SIZE);
+
+ #ifdef __linux__
+     if (header->kind == MEM_KIND_MMAP) {
+         munmap(header->base, header->length);
+         return;
+     }
+ #endif
+
+     free(header->base);
+ }
+
+ /**
+  * Prints the active policies and how often a request could not be honoured
+  */
+ void mem_print_status(void) {
+     printf("Kebijakan memori: shared=%s, scratch=%s (hugetlb fallback: %zu, NUMA gagal: %zu)\n",
+            mem_policy_name(mem_policies[MEM_ROLE_SHARED]),
+            mem_policy_name(mem_policies[MEM_ROLE_SCRATCH]),
+            mem_hugetlb_fallbacks, mem_numa_failures);
+ }
+
+ #endif // MEMORY_POLICY_H
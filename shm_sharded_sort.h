@@ -0,0 +1,441 @@
+/**
+ * shm_sharded_sort.h
+ * Multi-process sharded sort: the dataset lives in a POSIX shared memory segment,
+ * forked workers each sort one key-range shard with an existing algorithm
+ */
+
+ #ifndef SHM_SHARDED_SORT_H
+ #define SHM_SHARDED_SORT_H
+
+ #include <stdint.h>
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+
+ #if defined(__unix__) || defined(__APPLE__)
+ #define SHARDED_SORT_SUPPORTED 1
+ #include <fcntl.h>
+ #include <signal.h>
+ #include <sys/mman.h>
+ #include <sys/wait.h>
+ #include <unistd.h>
+ #else
+ #define SHARDED_SORT_SUPPORTED 0
+ #endif
+
+ #define SHARD_MAX_WORKERS 64
+ #define SHARD_SAMPLES_PER_WORKER 64
+ #define SHARD_MAX_ATTEMPTS 3          // Forked attempts per shard before the coordinator sorts it itself
+ #define SHARD_ALIGN 64
+ #define SHARD_DEFAULT_TIMEOUT 120.0   // Seconds before a worker counts as hung (SORT_SHARD_TIMEOUT overrides)
+ #define SHARD_POLL_NS 1000000         // Coordinator poll interval while workers run
+
+ /**
+  * Timings and recovery counters of one sharded sort run (wall-clock seconds)
+  */
+ typedef struct {
+     double partition_time;   // Splitter sampling and scattering into shards by the coordinator
+     double sort_time;        // Workers sorting their shards
+     double total_time;       // Segment setup to final order copied back
+     size_t shard_sizes[SHARD_MAX_WORKERS];
+     int workers;
+     int retried_shards;      // Shards that needed more than one forked attempt
+     int killed_workers;      // Workers killed after missing the deadline
+     int local_shards;        // Shards the coordinator had to sort in-process
+ } shard_stats;
+
+ /**
+  * Header at the start of the shared segment
+  */
+ typedef struct {
+     size_t shard_offset[SHARD_MAX_WORKERS + 1];   // Start of each shard in the data regions
+     volatile int shard_done[SHARD_MAX_WORKERS];
+ } shard_header;
+
+ /**
+  * Wall-clock time in seconds. clock() only measures the calling process and
+  * would miss the work done by the workers.
+  */
+ double shard_wall_time(void) {
+ #if SHARDED_SORT_SUPPORTED
+     struct timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return ts.tv_sec + ts.tv_nsec / 1e9;
+ #else
+     return (double)clock() / CLOCKS_PER_SEC;
+ #endif
+ }
+
+ size_t shard_align(size_t bytes) {
+     return (bytes + SHARD_ALIGN - 1) & ~(size_t)(SHARD_ALIGN - 1);
+ }
+
+ /**
+  * Local xorshift64 generator for the splitter sample, so sampling is
+  * deterministic and leaves the caller's rand() sequence untouched
+  */
+ uint64_t shard_next_random(uint64_t *state) {
+     uint64_t x = *state;
+     x ^= x << 13;
+     x ^= x >> 7;
+     x ^= x << 17;
+     *state = x;
+     return x;
+ }
+
+ /**
+  * Returns the shard of elem: the number of splitters that are <= elem
+  */
+ int shard_of(const unsigned char *elem, const unsigned char *splitters, int splitter_count, size_t size,
+              int (*compare)(const void *, const void *)) {
+     int lo = 0, hi = splitter_count;
+
+     while (lo < hi) {
+         int mid = lo + (hi - lo) / 2;
+         if (compare(splitters + mid * size, elem) <= 0) {
+             lo = mid + 1;
+         } else {
+             hi = mid;
+         }
+     }
+
+     return lo;
+ }
+
+ #if SHARDED_SORT_SUPPORTED
+ /**
+  * Body of one worker: copies its shard from the partitioned region into the
+  * output region and sorts it there. The partitioned copy stays intact, so a
+  * shard whose worker died half way can simply be run again.
+  */
+ void shard_worker_run(shard_header *header, const unsigned char *partitioned, unsigned char *output,
+                       size_t size, int shard, int (*compare)(const void *, const void *),
+                       void (*sort_func)(void*, size_t, size_t, int(*)(const void*, const void*))) {
+     size_t begin = header->shard_offset[shard];
+     size_t end = header->shard_offset[shard + 1];
+
+     memcpy(output + begin * size, partitioned + begin * size, (end - begin) * size);
+     sort_func(output + begin * size, end - begin, size, compare);
+ }
+
+ /**
+  * Forks one attempt at a shard. SORT_SHARD_CRASH=<shard> makes the first attempt
+  * of that shard abort and SORT_SHARD_HANG=<shard> makes it hang, so both recovery
+  * paths can be exercised.
+  */
+ pid_t shard_spawn(shard_header *header, const unsigned char *partitioned, unsigned char *output,
+                   size_t size, int shard, int attempt, int (*compare)(const void *, const void *),
+                   void (*sort_func)(void*, size_t, size_t, int(*)(const void*, const void*))) {
+     pid_t pid = fork();
+
+     if (pid == 0) {
+         const char *crash = getenv("SORT_SHARD_CRASH");
+         const char *hang = getenv("SORT_SHARD_HANG");
+         if (attempt == 0 && crash && atoi(crash) == shard) {
+             abort();
+         }
+         if (attempt == 0 && hang && atoi(hang) == shard) {
+             for (;;) pause();
+         }
+
+         shard_worker_run(header, partitioned, output, size, shard, compare, sort_func);
+         header->shard_done[shard] = 1;
+         _exit(0);
+     }
+
+     return pid;
+ }
+
+ /**
+  * Runs every shard in its own process until all are done. Workers that crash,
+  * exit without finishing or miss the deadline are killed and re-forked; after
+  * SHARD_MAX_ATTEMPTS the coordinator sorts the shard itself.
+  */
+ void shard_run_workers(shard_header *header, const unsigned char *partitioned, unsigned char *output,
+                        size_t size, int workers, int (*compare)(const void *, const void *),
+                        void (*sort_func)(void*, size_t, size_t, int(*)(const void*, const void*)),
+                        shard_stats *stats) {
+     pid_t pids[SHARD_MAX_WORKERS];
+     int attempts[SHARD_MAX_WORKERS] = {0};
+     double started[SHARD_MAX_WORKERS];
+     int finished[SHARD_MAX_WORKERS] = {0};
+
+     double timeout = SHARD_DEFAULT_TIMEOUT;
+     const char *timeout_env = getenv("SORT_SHARD_TIMEOUT");
+     if (timeout_env && atof(timeout_env) > 0.0) {
+         timeout = atof(timeout_env);
+     }
+
+     fflush(stdout);
+     for (int s = 0; s < workers; s++) {
+         pids[s] = shard_spawn(header, partitioned, output, size, s, 0, compare, sort_func);
+         started[s] = shard_wall_time();
+     }
+
+     int remaining = workers;
+     while (remaining > 0) {
+         int progressed = 0;
+
+         for (int s = 0; s < workers; s++) {
+             if (finished[s]) continue;
+
+             int status = 0;
+             int failed = 0;
+
+             if (pids[s] < 0) {
+                 // A failed fork is treated like a crashed worker
+                 failed = 1;
+             } else {
+                 pid_t done = waitpid(pids[s], &status, WNOHANG);
+                 if (done == 0) {
+                     if (shard_wall_time() - started[s] < timeout) continue;
+
+                     // Hung worker: kill it and reap it before retrying
+                     kill(pids[s], SIGKILL);
+                     waitpid(pids[s], &status, 0);
+                     stats->killed_workers++;
+                     failed = 1;
+                 } else if (done < 0) {
+                     failed = 1;
+                 } else {
+                     failed = !(WIFEXITED(status) && WEXITSTATUS(status) == 0 && header->shard_done[s]);
+                 }
+             }
+
+             progressed = 1;
+             attempts[s]++;
+
+             if (!failed) {
+                 finished[s] = 1;
+                 remaining--;
+                 continue;
+             }
+
+             if (attempts[s] == 1) {
+                 stats->retried_shards++;
+             }
+
+             if (attempts[s] < SHARD_MAX_ATTEMPTS) {
+                 pids[s] = shard_spawn(header, partitioned, output, size, s, attempts[s], compare, sort_func);
+                 started[s] = shard_wall_time();
+             } else {
+                 // Give up on forking and sort the shard in the coordinator
+                 shard_worker_run(header, partitioned, output, size, s, compare, sort_func);
+                 header->shard_done[s] = 1;
+                 stats->local_shards++;
+                 finished[s] = 1;
+                 remaining--;
+             }
+         }
+
+         if (!progressed) {
+             struct timespec pause_time = { 0, SHARD_POLL_NS };
+             nanosleep(&pause_time, NULL);
+         }
+     }
+ }
+
+ /**
+  * Shared implementation of sharded_sort and sharded_sort_strings.
+  * With pack_words set, arr holds char* and the word bytes are copied into the
+  * segment as records of { original pointer, bytes }; the workers sort pointers
+  * into those records and the original pointers are restored at the end.
+  */
+ int sharded_sort_run(void *arr, size_t n, size_t size, int (*compare)(const void *, const void *),
+                      void (*sort_func)(void*, size_t, size_t, int(*)(const void*, const void*)),
+                      int workers, shard_stats *stats, int pack_words) {
+     if (workers < 1) workers = 1;
+     if (workers > SHARD_MAX_WORKERS) workers = SHARD_MAX_WORKERS;
+     stats->workers = workers;
+
+     double start_total = shard_wall_time();
+     unsigned char *elems = (unsigned char *)arr;
+
+     // Word records keep the caller's pointer in front of the bytes, 8-byte aligned
+     size_t word_bytes = 0;
+     if (pack_words) {
+         for (size_t i = 0; i < n; i++) {
+             word_bytes += (sizeof(char*) + strlen(((char **)arr)[i]) + 1 + 7) & ~(size_t)7;
+         }
+     }
+
+     // Segment layout: header | partitioned elements | output elements | word records
+     size_t header_bytes = shard_align(sizeof(shard_header));
+     size_t data_bytes = shard_align(n * size);
+     size_t segment_bytes = header_bytes + 2 * data_bytes + shard_align(word_bytes);
+
+     char name[64];
+     snprintf(name, sizeof(name), "/sorting_shard_%ld", (long)getpid());
+
+     int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+     if (fd < 0) {
+         perror("shm_open failed");
+         return -1;
+     }
+
+     if (ftruncate(fd, (off_t)segment_bytes) != 0) {
+         perror("ftruncate failed");
+         close(fd);
+         shm_unlink(name);
+         return -1;
+     }
+
+     unsigned char *segment = (unsigned char *)mmap(NULL, segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+     close(fd);
+     // The mapping stays valid after unlinking, and nothing leaks if we crash
+     shm_unlink(name);
+     if (segment == (unsigned char *)MAP_FAILED) {
+         perror("mmap failed");
+         return -1;
+     }
+
+     shard_header *header = (shard_header *)segment;
+     unsigned char *partitioned = segment + header_bytes;
+     unsigned char *output = partitioned + data_bytes;
+     unsigned char *words = output + data_bytes;
+     memset(header, 0, sizeof(shard_header));
+
+     unsigned char *bucket_of = (unsigned char *)malloc(n ? n : 1);
+     char **packed = pack_words ? (char **)malloc((n ? n : 1) * sizeof(char*)) : NULL;
+     if (!bucket_of || (pack_words && !packed)) {
+         free(bucket_of);
+         free(packed);
+         munmap(segment, segment_bytes);
+         return -1;
+     }
+
+     // Move the word bytes into the segment; the workers only see these copies
+     if (pack_words) {
+         unsigned char *record = words;
+         for (size_t i = 0; i < n; i++) {
+             char *word = ((char **)arr)[i];
+             size_t length = strlen(word) + 1;
+             memcpy(record, &word, sizeof(char*));
+             memcpy(record + sizeof(char*), word, length);
+             packed[i] = (char *)(record + sizeof(char*));
+             record += (sizeof(char*) + length + 7) & ~(size_t)7;
+         }
+         elems = (unsigned char *)packed;
+     }
+
+     // Sample splitters: sort a random sample and take evenly spaced elements
+     double start_partition = shard_wall_time();
+     int splitter_count = workers - 1;
+     size_t sample_count = (size_t)workers * SHARD_SAMPLES_PER_WORKER;
+     if (sample_count > n) sample_count = n;
+
+     unsigned char *sample = (unsigned char *)malloc((sample_count ? sample_count : 1) * size);
+     unsigned char *splitters = (unsigned char *)malloc((splitter_count ? splitter_count : 1) * size);
+     if (!sample || !splitters) {
+         free(sample);
+         free(splitters);
+         free(bucket_of);
+         free(packed);
+         munmap(segment, segment_bytes);
+         return -1;
+     }
+
+     uint64_t sample_state = 0x9E3779B97F4A7C15ULL;
+     for (size_t i = 0; i < sample_count; i++) {
+         size_t pick = (size_t)(shard_next_random(&sample_state) % n);
+         memcpy(sample + i * size, elems + pick * size, size);
+     }
+     sort_func(sample, sample_count, size, compare);
+
+     if (sample_count == 0) splitter_count = 0;
+     for (int s = 0; s < splitter_count; s++) {
+         size_t idx = (size_t)(s + 1) * sample_count / workers;
+         memcpy(splitters + s * size, sample + idx * size, size);
+     }
+
+     // Assign every element to a shard, then scatter each element once into its shard
+     size_t counts[SHARD_MAX_WORKERS] = {0};
+     for (size_t i = 0; i < n; i++) {
+         int shard = shard_of(elems + i * size, splitters, splitter_count, size, compare);
+         bucket_of[i] = (unsigned char)shard;
+         counts[shard]++;
+     }
+
+     size_t next[SHARD_MAX_WORKERS];
+     header->shard_offset[0] = 0;
+     for (int s = 0; s < workers; s++) {
+         header->shard_offset[s + 1] = header->shard_offset[s] + counts[s];
+         next[s] = header->shard_offset[s];
+         stats->shard_sizes[s] = counts[s];
+     }
+
+     for (size_t i = 0; i < n; i++) {
+         memcpy(partitioned + next[bucket_of[i]]++ * size, elems + i * size, size);
+     }
+     stats->partition_time = shard_wall_time() - start_partition;
+
+     free(sample);
+     free(splitters);
+     free(bucket_of);
+
+     double start_sort = shard_wall_time();
+     shard_run_workers(header, partitioned, output, size, workers, compare, sort_func, stats);
+     stats->sort_time = shard_wall_time() - start_sort;
+
+     // Shards are contiguous and ordered, so the output region is the final order
+     if (pack_words) {
+         char **result = (char **)arr;
+         for (size_t i = 0; i < n; i++) {
+             char *word;
+             memcpy(&word, output + i * size, sizeof(char*));
+             memcpy(&result[i], word - sizeof(char*), sizeof(char*));
+         }
+     } else {
+         memcpy(arr, output, n * size);
+     }
+
+     free(packed);
+     munmap(segment, segment_bytes);
+     stats->total_time = shard_wall_time() - start_total;
+     return 0;
+ }
+ #endif
+
+ /**
+  * Sharded Sort
+  * Copies arr into a shared memory segment, range-partitions it by sampled
+  * splitters and lets `workers` forked processes each sort one shard with
+  * sort_func. Elements are opaque fixed-size values; for char* arrays use
+  * sharded_sort_strings so the word bytes live in the segment too. A worker
+  * that crashes or hangs has its shard re-run.
+  * Returns 0 on success, -1 on failure (arr is left untouched).
+  */
+ int sharded_sort(void *arr, size_t n, size_t size, int (*compare)(const void *, const void *),
+                  void (*sort_func)(void*, size_t, size_t, int(*)(const void*, const void*)),
+                  int workers, shard_stats *stats) {
+     memset(stats, 0, sizeof(*stats));
+
+ #if SHARDED_SORT_SUPPORTED
+     return sharded_sort_run(arr, n, size, compare, sort_func, workers, stats, 0);
+ #else
+     (void)arr; (void)n; (void)size; (void)compare; (void)sort_func; (void)workers;
+     return -1;
+ #endif
+ }
+
+ /**
+  * Sharded sort for an array of words: the word bytes are packed into the
+  * shared segment and the workers sort pointers into it with compare (which
+  * receives char** like compare_string). arr ends up holding its own pointers
+  * in sorted order. Returns 0 on success, -1 on failure.
+  */
+ int sharded_sort_strings(char **arr, size_t n, int (*compare)(const void *, const void *),
+                          void (*sort_func)(void*, size_t, size_t, int(*)(const void*, const void*)),
+                          int workers, shard_stats *stats) {
+     memset(stats, 0, sizeof(*stats));
+
+ #if SHARDED_SORT_SUPPORTED
+     return sharded_sort_run(arr, n, sizeof(char*), compare, sort_func, workers, stats, 1);
+ #else
+     (void)arr; (void)n; (void)compare; (void)sort_func; (void)workers;
+     return -1;
+ #endif
+ }
+
+ #endif // SHM_SHARDED_SORT_H
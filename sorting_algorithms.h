@@ -6,8 +6,13 @@
  #ifndef SORTING_ALGORITHMS_H
  #define SORTING_ALGORITHMS_H
  
+ #include <stddef.h>
  #include <stdlib.h>
  #include <string.h>
+ #include "memory_policy.h"
+ 
+ #define BOTTOM_UP_SMALL_RUN 16          // Runs insertion sorted before any merging
+ #define BOTTOM_UP_L1_BYTES (32 * 1024)  // Typical L1 data cache size
  
  /**
   * Bubble Sort
@@ -95,15 +100,16 @@
  
  /**
   * Helper function for merge sort - merges two subarrays
+  * L and R are copied into the matching range of the shared scratch buffer
   */
- void merge(unsigned char *arr, size_t l, size_t m, size_t r, size_t size, int (*compare)(const void *, const void *)) {
+ void merge(unsigned char *arr, unsigned char *scratch, size_t l, size_t m, size_t r, size_t size, int (*compare)(const void *, const void *)) {
      size_t i, j, k;
      size_t n1 = m - l + 1;
      size_t n2 = r - m;
      
-     // Create temporary arrays
-     unsigned char *L = (unsigned char *)malloc(n1 * size);
-     unsigned char *R = (unsigned char *)malloc(n2 * size);
+     // Temporary arrays live in the scratch buffer allocated once per sort
+     unsigned char *L = scratch + l * size;
+     unsigned char *R = scratch + (m + 1) * size;
      
      // Copy data to temporary arrays
      for (i = 0; i < n1; i++)
@@ -141,22 +147,19 @@
          j++;
          k++;
      }
-     
-     free(L);
-     free(R);
  }
  
  /**
   * Helper function for merge sort - recursive implementation
   */
- void merge_sort_recursive(unsigned char *arr, size_t l, size_t r, size_t size, int (*compare)(const void *, const void *)) {
+ void merge_sort_recursive(unsigned char *arr, unsigned char *scratch, size_t l, size_t r, size_t size, int (*compare)(const void *, const void *)) {
      if (l < r) {
          size_t m = l + (r - l) / 2;
          
-         merge_sort_recursive(arr, l, m, size, compare);
-         merge_sort_recursive(arr, m + 1, r, size, compare);
+         merge_sort_recursive(arr, scratch, l, m, size, compare);
+         merge_sort_recursive(arr, scratch, m + 1, r, size, compare);
          
-         merge(arr, l, m, r, size, compare);
+         merge(arr, scratch, l, m, r, size, compare);
      }
  }
  
@@ -169,7 +172,11 @@
      unsigned char *a = (unsigned char *)arr;
      
      if (n > 1) {
-         merge_sort_recursive(a, 0, n - 1, size, compare);
+         unsigned char *scratch = (unsigned char *)mem_alloc(n * size, MEM_ROLE_SCRATCH);
+         if (!scratch) return;
+         
+         merge_sort_recursive(a, scratch, 0, n - 1, size, compare);
+         mem_free(scratch);
      }
  }
  
@@ -273,4 +280,271 @@
      free(temp);
  }
  
+ /**
+  * Helper function for bottom-up merge sort - copies one element.
+  * Constant sizes let the compiler turn the common int and pointer cases into a single move.
+  */
+ static inline void elem_copy(unsigned char *dst, const unsigned char *src, size_t size) {
+     switch (size) {
+         case 4: memcpy(dst, src, 4); return;
+         case 8: memcpy(dst, src, 8); return;
+         case 16: memcpy(dst, src, 16); return;
+         default: memcpy(dst, src, size); return;
+     }
+ }
+ 
+ /**
+  * Helper function for bottom-up merge sort - insertion sorts one small run
+  */
+ void bottom_up_insertion_run(unsigned char *a, size_t n, size_t size, unsigned char *key,
+                              int (*compare)(const void *, const void *)) {
+     for (size_t i = 1; i < n; i++) {
+         elem_copy(key, a + i * size, size);
+         size_t j = i;
+         
+         while (j > 0 && compare(a + (j - 1) * size, key) > 0) {
+             elem_copy(a + j * size, a + (j - 1) * size, size);
+             j--;
+         }
+         
+         elem_copy(a + j * size, key, size);
+     }
+ }
+ 
+ /**
+  * Helper function for bottom-up merge sort - two-way merge into out.
+  * The selected source is computed from the comparison result instead of branching on it.
+  */
+ void merge_branchless(const unsigned char *l, size_t nl, const unsigned char *r, size_t nr,
+                       unsigned char *out, size_t size, int (*compare)(const void *, const void *)) {
+     const unsigned char *l_end = l + nl * size;
+     const unsigned char *r_end = r + nr * size;
+     
+     while (l < l_end && r < r_end) {
+         // Ties keep the left element first so the sort stays stable
+         size_t take_r = compare(r, l) < 0;
+         elem_copy(out, take_r ? r : l, size);
+         out += size;
+         r += take_r * size;
+         l += (1 - take_r) * size;
+     }
+     
+     memcpy(out, l, (size_t)(l_end - l));
+     out += l_end - l;
+     memcpy(out, r, (size_t)(r_end - r));
+ }
+ 
+ /**
+  * Helper function for bottom-up merge sort - bidirectional two-way merge.
+  * Fills the output from the front (smallest first) and from the back (largest first)
+  * in the same loop, giving two independent dependency chains. The runs must differ
+  * in length by at most one, which guarantees neither end reads past its run.
+  */
+ void merge_bidirectional(const unsigned char *l, size_t nl, const unsigned char *r, size_t nr,
+                          unsigned char *out, size_t size, int (*compare)(const void *, const void *)) {
+     size_t n = nl + nr;
+     const unsigned char *lf = l, *rf = r;
+     ptrdiff_t lb = (ptrdiff_t)nl - 1, rb = (ptrdiff_t)nr - 1;
+     unsigned char *of = out;
+     unsigned char *ob = out + (n - 1) * size;
+     
+     for (size_t k = n / 2; k > 0; k--) {
+         size_t take_r = compare(rf, lf) < 0;
+         elem_copy(of, take_r ? rf : lf, size);
+         of += size;
+         rf += take_r * size;
+         lf += (1 - take_r) * size;
+         
+         // Ties put the right element last, mirroring the front
+         ptrdiff_t take_l = compare(l + lb * size, r + rb * size) > 0;
+         elem_copy(ob, take_l ? l + lb * size : r + rb * size, size);
+         ob -= size;
+         lb -= take_l;
+         rb -= 1 - take_l;
+     }
+     
+     // With an odd total exactly one element is left, in whichever run is not used up
+     if (n & 1) {
+         elem_copy(of, lf <= l + lb * size ? lf : rf, size);
+     }
+ }
+ 
+ /**
+  * Helper function for bottom-up merge sort - index of the smaller head of runs i and j.
+  * The index is computed from the comparison result instead of branching on it.
+  * Ties go to i, which must be the earlier run, so the merge stays stable.
+  */
+ static inline int four_way_select(const unsigned char **head, int i, int j,
+                                   int (*compare)(const void *, const void *)) {
+     int take_j = compare(head[j], head[i]) < 0;
+     return i + (j - i) * take_j;
+ }
+ 
+ /**
+  * Helper function for bottom-up merge sort - merges four adjacent runs in one pass.
+  * The winners of runs (0,1) and (2,3) are cached, so each output element costs two
+  * comparisons, the same as two two-way passes but with half the memory traffic.
+  * Run exhaustion is not checked per element: the inner loop emits batches of
+  * min(remaining) elements, which cannot empty any run, and empty runs are dropped
+  * between batches. Three runs reuse the same loop with run 2 paired with itself;
+  * the last two runs finish with merge_branchless.
+  */
+ void merge_four_way(const unsigned char **head, const unsigned char **end, unsigned char *out,
+                     size_t size, int (*compare)(const void *, const void *)) {
+     int k = 0;
+     
+     // Drop empty runs, keeping the rest in order for stability
+     for (int r = 0; r < 4; r++) {
+         if (head[r] != end[r]) {
+             head[k] = head[r];
+             end[k] = end[r];
+             k++;
+         }
+     }
+     
+     while (k >= 3) {
+         size_t safe = (size_t)(end[0] - head[0]);
+         for (int r = 1; r < k; r++) {
+             size_t remaining = (size_t)(end[r] - head[r]);
+             if (remaining < safe) safe = remaining;
+         }
+         safe /= size;
+         
+         int last = k - 1;   // Partner of run 2: run 3, or run 2 itself with three runs
+         int w01 = four_way_select(head, 0, 1, compare);
+         int w23 = four_way_select(head, 2, last, compare);
+         
+         for (size_t t = 1; ; t++) {
+             int w = four_way_select(head, w01, w23, compare);
+             elem_copy(out, head[w], size);
+             out += size;
+             head[w] += size;
+             
+             if (t == safe) break;
+             
+             // Replay only the pair the winner came from
+             int pair = w >> 1;
+             int wp = four_way_select(head, pair << 1, 1 + pair * (last - 1), compare);
+             w01 += (wp - w01) * (1 - pair);
+             w23 += (wp - w23) * pair;
+         }
+         
+         int kept = 0;
+         for (int r = 0; r < k; r++) {
+             if (head[r] != end[r]) {
+                 head[kept] = head[r];
+                 end[kept] = end[r];
+                 kept++;
+             }
+         }
+         k = kept;
+     }
+     
+     if (k == 2) {
+         merge_branchless(head[0], (size_t)(end[0] - head[0]) / size, head[1], (size_t)(end[1] - head[1]) / size,
+                          out, size, compare);
+     } else if (k == 1) {
+         memcpy(out, head[0], (size_t)(end[0] - head[0]));
+     }
+ }
+ 
+ /**
+  * Helper function for bottom-up merge sort - fully sorts one L1-sized block in place
+  */
+ void bottom_up_sort_block(unsigned char *a, unsigned char *scratch, size_t n, size_t size, unsigned char *key,
+                           int (*compare)(const void *, const void *)) {
+     for (size_t s = 0; s < n; s += BOTTOM_UP_SMALL_RUN) {
+         size_t run = (n - s < BOTTOM_UP_SMALL_RUN) ? n - s : BOTTOM_UP_SMALL_RUN;
+         bottom_up_insertion_run(a + s * size, run, size, key, compare);
+     }
+     
+     unsigned char *src = a;
+     unsigned char *dst = scratch;
+     
+     for (size_t width = BOTTOM_UP_SMALL_RUN; width < n; width *= 2) {
+         for (size_t s = 0; s < n; s += 2 * width) {
+             size_t nl = (n - s < width) ? n - s : width;
+             size_t nr = (n - s - nl < width) ? n - s - nl : width;
+             const unsigned char *l = src + s * size;
+             const unsigned char *r = l + nl * size;
+             
+             if (nr == 0) {
+                 memcpy(dst + s * size, l, nl * size);
+             } else if (nl <= nr + 1 && nr <= nl + 1) {
+                 merge_bidirectional(l, nl, r, nr, dst + s * size, size, compare);
+             } else {
+                 merge_branchless(l, nl, r, nr, dst + s * size, size, compare);
+             }
+         }
+         
+         unsigned char *swap = src;
+         src = dst;
+         dst = swap;
+     }
+     
+     if (src != a) {
+         memcpy(a, src, n * size);
+     }
+ }
+ 
+ /**
+  * Bottom-Up Merge Sort
+  * Cache-oriented merge sort: each L1-sized block is sorted completely (insertion-sorted
+  * small runs, then bidirectional branchless merges) before it leaves the cache, after
+  * which the blocks are combined with four-way merge passes.
+  * Complexity: O(n log n) time, O(n) space
+  */
+ void merge_sort_bottom_up(void *arr, size_t n, size_t size, int (*compare)(const void *, const void *)) {
+     unsigned char *a = (unsigned char *)arr;
+     
+     if (n < 2) return;
+     
+     // One scratch buffer for the whole sort plus room for the insertion key
+     unsigned char *scratch = (unsigned char *)mem_alloc(n * size + size, MEM_ROLE_SCRATCH);
+     if (!scratch) return;
+     unsigned char *key = scratch + n * size;
+     
+     // Largest power-of-two multiple of the small run whose data and scratch fit in L1
+     size_t block = BOTTOM_UP_SMALL_RUN;
+     while (block * 2 * size * 2 <= BOTTOM_UP_L1_BYTES) {
+         block *= 2;
+     }
+     
+     for (size_t s = 0; s < n; s += block) {
+         size_t bn = (n - s < block) ? n - s : block;
+         bottom_up_sort_block(a + s * size, scratch + s * size, bn, size, key, compare);
+     }
+     
+     unsigned char *src = a;
+     unsigned char *dst = scratch;
+     
+     for (size_t width = block; width < n; width *= 4) {
+         for (size_t s = 0; s < n; s += 4 * width) {
+             const unsigned char *head[4];
+             const unsigned char *end[4];
+             
+             for (int r = 0; r < 4; r++) {
+                 size_t begin = s + r * width;
+                 size_t stop = begin + width;
+                 if (begin > n) begin = n;
+                 if (stop > n) stop = n;
+                 head[r] = src + begin * size;
+                 end[r] = src + stop * size;
+             }
+             
+             merge_four_way(head, end, dst + s * size, size, compare);
+         }
+         
+         unsigned char *swap = src;
+         src = dst;
+         dst = swap;
+     }
+     
+     if (src != a) {
+         memcpy(a, src, n * size);
+     }
+     
+     mem_free(scratch);
+ }
+ 
  #endif // SORTING_ALGORITHMS_H
\ No newline at end of file
@@ -0,0 +1,261 @@
+/**
+ * word_dictionary.h
+ * Hash-based word dictionary used to sort duplicate-heavy word data on unique keys only
+ */
+
+ #ifndef WORD_DICTIONARY_H
+ #define WORD_DICTIONARY_H
+
+ #include <stdint.h>
+ #include <stdlib.h>
+ #include <string.h>
+
+ #define WORD_POOL_CHUNK_SIZE (1 << 20)
+ #define WORD_DICTIONARY_INITIAL_KEYS 1024   // Starting size; the table grows with the unique count
+
+ /**
+  * A run of identical words in sorted order: the interned word and how often it occurred
+  */
+ typedef struct {
+     const char *word;
+     size_t count;
+ } word_run;
+
+ /**
+  * Hash table slot. An empty slot has word == NULL.
+  */
+ typedef struct {
+     char *word;
+     uint64_t hash;
+     size_t count;
+ } word_entry;
+
+ /**
+  * Chunk of the string pool that owns every interned word
+  */
+ typedef struct word_pool_chunk {
+     struct word_pool_chunk *next;
+     size_t used;
+     size_t capacity;
+     char data[];
+ } word_pool_chunk;
+
+ typedef struct {
+     word_entry *slots;
+     size_t capacity;      // Always a power of two
+     size_t unique_count;
+     size_t total_count;
+     word_pool_chunk *pool;
+ } word_dictionary;
+
+ /**
+  * FNV-1a 64-bit hash of a NUL-terminated word, also reports the word length
+  */
+ uint64_t word_hash(const char *word, size_t *length) {
+     uint64_t h = 14695981039346656037ULL;
+     const unsigned char *p = (const unsigned char *)word;
+
+     while (*p) {
+         h ^= *p++;
+         h *= 1099511628211ULL;
+     }
+
+     *length = (size_t)(p - (const unsigned char *)word);
+     return h;
+ }
+
+ /**
+  * Copies a word into the string pool and returns the interned copy
+  */
+ char* word_pool_intern(word_dictionary *dict, const char *word, size_t length) {
+     word_pool_chunk *chunk = dict->pool;
+
+     if (!chunk || chunk->used + length + 1 > chunk->capacity) {
+         size_t capacity = WORD_POOL_CHUNK_SIZE;
+         if (length + 1 > capacity) {
+             capacity = length + 1;
+         }
+
+         chunk = (word_pool_chunk *)malloc(sizeof(word_pool_chunk) + capacity);
+         if (!chunk) return NULL;
+
+         chunk->next = dict->pool;
+         chunk->used = 0;
+         chunk->capacity = capacity;
+         dict->pool = chunk;
+     }
+
+     char *copy = chunk->data + chunk->used;
+     memcpy(copy, word, length + 1);
+     chunk->used += length + 1;
+     return copy;
+ }
+
+ /**
+  * Initializes an empty dictionary sized for roughly expected_unique keys.
+  * Returns 0 on success, -1 on allocation failure.
+  */
+ int word_dictionary_init(word_dictionary *dict, size_t expected_unique) {
+     size_t capacity = 16;
+
+     // Keep the load factor at or below 1/2
+     while (capacity < expected_unique * 2) {
+         capacity <<= 1;
+     }
+
+     dict->slots = (word_entry *)calloc(capacity, sizeof(word_entry));
+     if (!dict->slots) return -1;
+
+     dict->capacity = capacity;
+     dict->unique_count = 0;
+     dict->total_count = 0;
+     dict->pool = NULL;
+     return 0;
+ }
+
+ /**
+  * Doubles the table and re-inserts every entry using the stored hashes
+  */
+ int word_dictionary_grow(word_dictionary *dict) {
+     size_t new_capacity = dict->capacity * 2;
+     word_entry *new_slots = (word_entry *)calloc(new_capacity, sizeof(word_entry));
+     if (!new_slots) return -1;
+
+     size_t mask = new_capacity - 1;
+     for (size_t i = 0; i < dict->capacity; i++) {
+         word_entry *entry = &dict->slots[i];
+         if (!entry->word) continue;
+
+         size_t pos = (size_t)entry->hash & mask;
+         while (new_slots[pos].word) {
+             pos = (pos + 1) & mask;
+         }
+         new_slots[pos] = *entry;
+     }
+
+     free(dict->slots);
+     dict->slots = new_slots;
+     dict->capacity = new_capacity;
+     return 0;
+ }
+
+ /**
+  * Adds one occurrence of word, interning it on first sight.
+  * Returns 0 on success, -1 on allocation failure.
+  */
+ int word_dictionary_add(word_dictionary *dict, const char *word) {
+     if ((dict->unique_count + 1) * 2 > dict->capacity) {
+         if (word_dictionary_grow(dict) != 0) return -1;
+     }
+
+     size_t length;
+     uint64_t hash = word_hash(word, &length);
+     size_t mask = dict->capacity - 1;
+     size_t pos = (size_t)hash & mask;
+
+     // Linear probing until the word or an empty slot is found
+     while (dict->slots[pos].word) {
+         word_entry *entry = &dict->slots[pos];
+         if (entry->hash == hash && strcmp(entry->word, word) == 0) {
+             entry->count++;
+             dict->total_count++;
+             return 0;
+         }
+         pos = (pos + 1) & mask;
+     }
+
+     char *copy = word_pool_intern(dict, word, length);
+     if (!copy) return -1;
+
+     dict->slots[pos].word = copy;
+     dict->slots[pos].hash = hash;
+     dict->slots[pos].count = 1;
+     dict->unique_count++;
+     dict->total_count++;
+     return 0;
+ }
+
+ /**
+  * Releases the table and every interned word
+  */
+ void word_dictionary_free(word_dictionary *dict) {
+     word_pool_chunk *chunk = dict->pool;
+     while (chunk) {
+         word_pool_chunk *next = chunk->next;
+         free(chunk);
+         chunk = next;
+     }
+
+     free(dict->slots);
+     dict->slots = NULL;
+     dict->pool = NULL;
+     dict->capacity = 0;
+     dict->unique_count = 0;
+     dict->total_count = 0;
+ }
+
+ /**
+  * Builds a dictionary from an array of words. The table starts small and doubles
+  * as unique words arrive, so its size follows the unique count, not the word count.
+  * Returns 0 on success, -1 on allocation failure (the dictionary is freed).
+  */
+ int word_dictionary_build(word_dictionary *dict, char **words, size_t count) {
+     if (word_dictionary_init(dict, WORD_DICTIONARY_INITIAL_KEYS) != 0) return -1;
+
+     for (size_t i = 0; i < count; i++) {
+         if (word_dictionary_add(dict, words[i]) != 0) {
+             word_dictionary_free(dict);
+             return -1;
+         }
+     }
+
+     return 0;
+ }
+
+ /**
+  * Compares two word runs by their word
+  */
+ int compare_word_run(const void *a, const void *b) {
+     return strcmp(((const word_run *)a)->word, ((const word_run *)b)->word);
+ }
+
+ /**
+  * Collects the unique keys as (word, count) runs and sorts them with sort_func.
+  * The returned array holds dict->unique_count runs and must be freed by the caller;
+  * the words stay owned by the dictionary.
+  */
+ word_run* word_dictionary_sorted_runs(word_dictionary *dict,
+                                       void (*sort_func)(void*, size_t, size_t, int(*)(const void*, const void*))) {
+     word_run *runs = (word_run *)malloc((dict->unique_count ? dict->unique_count : 1) * sizeof(word_run));
+     if (!runs) return NULL;
+
+     size_t k = 0;
+     for (size_t i = 0; i < dict->capacity; i++) {
+         if (dict->slots[i].word) {
+             runs[k].word = dict->slots[i].word;
+             runs[k].count = dict->slots[i].count;
+             k++;
+         }
+     }
+
+     sort_func(runs, k, sizeof(word_run), compare_word_run);
+     return runs;
+ }
+
+ /**
+  * Expands sorted runs into a flat array of word pointers (one entry per occurrence).
+  * out must have room for the total occurrence count. Returns the number of entries written.
+  */
+ size_t word_runs_expand(const word_run *runs, size_t run_count, const char **out) {
+     size_t k = 0;
+
+     for (size_t i = 0; i < run_count; i++) {
+         for (size_t c = 0; c < runs[i].count; c++) {
+             out[k++] = runs[i].word;
+         }
+     }
+
+     return k;
+ }
+
+ #endif // WORD_DICTIONARY_H